@@ -0,0 +1,528 @@
+/**
+ * @file bench.cpp
+ * @brief Замеры производительности генератора и сопутствующих алгоритмов
+ *
+ * @details
+ * Запуск: ./bench <режим> [число точек]
+ * - morton - стоимость сортировки по Мортону и выигрыш пространственных проходов
+ * - density - скорость выборки с профилями плотности и точность таблиц
+ * - load - загрузка points.txt: PointLoader против std::ifstream >>
+ *   (время np.loadtxt на том же формате - python visual.py --bench N)
+ * - clip - генерация в части конуса внутри куба или по одну сторону плоскости:
+ *   доля принятых точек и скорость против отбора из всего конуса
+ * - kernel - ядро ConeKernel с осью (и размерами) времени компиляции против
+ *   общего поворота базисом
+ * - raster - время встроенной отрисовки от числа точек (с -DHAVE_MGL -lmgl
+ *   также время MathGL, как в visualizePoints)
+ *
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cone_gen.h"
+#include "morton.h"
+#include "raster.h"
+#include "loader.h"
+#include "cone_clip.h"
+
+#ifdef HAVE_MGL
+#include <mgl2/mgl.h>
+#endif
+
+/**
+ * @brief Возвращает время в секундах от произвольного момента
+ * @return Время в секундах
+ */
+double now() {
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Генерирует count точек конуса через ConeGen::rndAt
+ * @param generator Генератор
+ * @param count Количество точек
+ * @return Массив точек
+ */
+std::vector<point3d> makePoints(const ConeGen& generator, size_t count) {
+    std::vector<point3d> points(count);
+    for (size_t i = 0; i < count; ++i) generator.rndAt(&points[i], i);
+    return points;
+}
+
+/**
+ * @brief Вокселизация: подсчет точек в ячейках сетки side^3
+ * @param points Точки
+ * @param lo Минимальный угол сетки
+ * @param hi Максимальный угол сетки
+ * @param side Число ячеек по оси
+ * @return Число непустых ячеек (чтобы проход не был выброшен компилятором)
+ */
+size_t voxelize(const std::vector<point3d>& points, const point3d& lo, const point3d& hi, int side) {
+    std::vector<uint32_t> grid(size_t(side) * side * side, 0);
+    point3d k(side / (hi.x - lo.x), side / (hi.y - lo.y), side / (hi.z - lo.z));
+    for (const point3d& p : points) {
+        int x = std::min(side - 1, std::max(0, int((p.x - lo.x) * k.x)));
+        int y = std::min(side - 1, std::max(0, int((p.y - lo.y) * k.y)));
+        int z = std::min(side - 1, std::max(0, int((p.z - lo.z) * k.z)));
+        ++grid[(size_t(z) * side + y) * side + x];
+    }
+    return grid.size() - std::count(grid.begin(), grid.end(), 0u);
+}
+
+/**
+ * @brief Замер сортировки по Мортону и выигрыша последующих проходов
+ * @param count Количество точек
+ */
+void benchMorton(size_t count) {
+    ConeGen generator(1.0, 2.0, point3d(), point3d(1, 1, 1));
+    generator.setSeed(1);
+    std::vector<point3d> random = makePoints(generator, count);
+    MortonOrder order(generator);
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "=== Сортировка по Мортону, " << count << " точек ===" << std::endl;
+
+    // Эталон: std::sort пар ключ-номер и перестановка точек
+    std::vector<point3d> sorted(count);
+    double t0 = now();
+    std::vector<std::pair<uint64_t, size_t>> keyed(count);
+    for (size_t i = 0; i < count; ++i) keyed[i] = {order.key(random[i]), i};
+    std::sort(keyed.begin(), keyed.end());
+    for (size_t i = 0; i < count; ++i) sorted[i] = random[keyed[i].second];
+    double stdTime = now() - t0;
+
+    for (unsigned threads : {1u, cores}) {
+        sorted = random;
+        t0 = now();
+        order.sort(sorted.data(), sorted.size(), threads);
+        double t = now() - t0;
+        std::cout << "Радиксная сортировка, потоков " << threads << ": " << t << " с ("
+                  << count / t / 1e6 << " млн точек/с)" << std::endl;
+        if (threads == cores) break;
+    }
+    std::cout << "std::sort по ключу (1 поток): " << stdTime << " с" << std::endl;
+
+    point3d lo, hi;
+    generator.getBounds(lo, hi);
+    for (int side : {128, 512}) {
+        t0 = now();
+        size_t a = voxelize(random, lo, hi, side);
+        double tRandom = now() - t0;
+        t0 = now();
+        size_t b = voxelize(sorted, lo, hi, side);
+        double tSorted = now() - t0;
+        std::cout << "Вокселизация " << side << "^3: случайный порядок " << tRandom
+                  << " с, Z-порядок " << tSorted << " с (ускорение " << tRandom / tSorted
+                  << "x, ячеек " << a << "/" << b << ")" << std::endl;
+    }
+
+    // Чтение области: таблица блоков против полного просмотра файла
+    const std::string filename = "bench_morton.bin";
+    if (!order.writeBuckets(filename, sorted.data(), sorted.size(), 5)) {
+        std::cout << "Ошибка записи " << filename << std::endl;
+        return;
+    }
+    point3d c = (lo + hi) * 0.5;
+    point3d d = (hi - lo) * 0.05;
+    point3d qlo = c - d, qhi = c + d;
+
+    std::vector<point3d> found;
+    size_t scanned = 0;
+    t0 = now();
+    MortonOrder::readRegion(filename, qlo, qhi, found, &scanned);
+    double tRegion = now() - t0;
+
+    t0 = now();
+    size_t full = 0;
+    std::vector<point3d> all;
+    MortonOrder::readRegion(filename, point3d(-1e300, -1e300, -1e300),
+                            point3d(1e300, 1e300, 1e300), all, nullptr);
+    for (const point3d& p : all) {
+        full += p.x >= qlo.x && p.x <= qhi.x && p.y >= qlo.y && p.y <= qhi.y &&
+                p.z >= qlo.z && p.z <= qhi.z;
+    }
+    double tFull = now() - t0;
+    std::remove(filename.c_str());
+
+    std::cout << "Область 10% по каждой оси: найдено " << found.size() << " (полный просмотр: "
+              << full << "), прочитано " << scanned << " из " << count << " точек" << std::endl;
+    std::cout << "Чтение по таблице блоков " << tRegion << " с, полный просмотр " << tFull
+              << " с (ускорение " << tFull / tRegion << "x)" << std::endl;
+}
+
+/**
+ * @brief Замер скорости генерации точек
+ * @param generator Генератор
+ * @param count Количество точек
+ * @return Миллионов точек в секунду
+ */
+double pointsPerSecond(const ConeGen& generator, size_t count) {
+    point3d p, sum;
+    double t0 = now();
+    for (size_t i = 0; i < count; ++i) {
+        generator.rndAt(&p, i);
+        sum = sum + p;
+    }
+    double t = now() - t0;
+    if (sum.x == 12345.678) std::cout << ""; // не даем выбросить цикл
+    return count / t / 1e6;
+}
+
+/**
+ * @brief Эталонная функция распределения плотности p(x) * x^power на [0, 1]
+ *
+ * Накопленные интегралы по Симпсону на сетке из 2^20 отрезков,
+ * между узлами - линейная интерполяция.
+ */
+struct ExactCdf {
+    std::vector<double> cdf; ///< F в узлах сетки
+
+    /**
+     * @brief Конструктор: накапливает интеграл
+     * @param density Профиль p
+     * @param power Степень якобиана
+     */
+    ExactCdf(const std::function<double(double)>& density, int power) : cdf((1 << 20) + 1, 0.0) {
+        const size_t n = cdf.size() - 1;
+        auto f = [&](double t) { return density(t) * std::pow(t, power); };
+        for (size_t i = 0; i < n; ++i) {
+            double a = double(i) / n, b = double(i + 1) / n;
+            cdf[i + 1] = cdf[i] + (b - a) / 6 * (f(a) + 4 * f((a + b) / 2) + f(b));
+        }
+        for (double& c : cdf) c /= cdf[n];
+    }
+
+    /**
+     * @brief Значение функции распределения
+     * @param x Точка из [0, 1]
+     * @return F(x)
+     */
+    double operator()(double x) const {
+        const size_t n = cdf.size() - 1;
+        double pos = std::min(1.0, std::max(0.0, x)) * n;
+        size_t i = std::min(n - 1, static_cast<size_t>(pos));
+        return cdf[i] + (pos - i) * (cdf[i + 1] - cdf[i]);
+    }
+};
+
+/**
+ * @brief Замер выборки с профилями плотности и точности таблиц
+ * @param count Количество точек
+ */
+void benchDensity(size_t count) {
+    auto gaussian = [](double s) { return std::exp(-s * s / 0.08); };
+    auto gradient = [](double t) { return t; };
+
+    std::cout << "=== Профили плотности, " << count << " точек ===" << std::endl;
+    ConeGen generator(1.0, 2.0);
+    generator.setSeed(1);
+    std::cout << "Равномерно (cbrt/sqrt):         " << pointsPerSecond(generator, count)
+              << " млн точек/с" << std::endl;
+    generator.setAxialDensity(gradient, 256, DensityTable::LINEAR);
+    generator.setRadialDensity(gaussian, 256, DensityTable::LINEAR);
+    std::cout << "Таблицы 256, линейная:          " << pointsPerSecond(generator, count)
+              << " млн точек/с" << std::endl;
+    generator.setAxialDensity(gradient, 256, DensityTable::CUBIC);
+    generator.setRadialDensity(gaussian, 256, DensityTable::CUBIC);
+    std::cout << "Таблицы 256, кубическая:        " << pointsPerSecond(generator, count)
+              << " млн точек/с" << std::endl;
+    generator.setAxialDensity(std::vector<double>{1, 2, 3, 4, 5, 6, 7, 8});
+    generator.setRadialDensity(std::vector<double>{8, 4, 2, 1});
+    std::cout << "Ступени (alias):                " << pointsPerSecond(generator, count)
+              << " млн точек/с" << std::endl;
+
+    // Точность: расстояние Колмогорова max |F(x(u)) - u| для точной F
+    std::cout << "Расстояние Колмогорова (гаусс по радиусу / градиент по оси):" << std::endl;
+    auto axialProfile = [&](double tau) { return gradient(1 - tau); };
+    ExactCdf radialCdf(gaussian, 1), axialCdf(axialProfile, 2);
+    for (size_t size : {8, 16, 32, 64, 128, 256, 1024, 4096}) {
+        std::cout << "  узлов " << size << ":";
+        for (auto interp : {DensityTable::LINEAR, DensityTable::CUBIC}) {
+            auto radial = DensityTable::fromFunction(gaussian, 1, size, interp);
+            auto axial = DensityTable::fromFunction(axialProfile, 2, size, interp);
+            double errRadial = 0, errAxial = 0;
+            for (int i = 0; i < 100000; ++i) {
+                double u = (i + 0.5) / 100000;
+                errRadial = std::max(errRadial, std::abs(radialCdf(radial->sample(u)) - u));
+                errAxial = std::max(errAxial, std::abs(axialCdf(axial->sample(u)) - u));
+            }
+            std::cout << (interp == DensityTable::LINEAR ? " линейная " : " кубическая ")
+                      << errRadial << " / " << errAxial;
+        }
+        std::cout << " (" << size * sizeof(double) / 1024.0 << " КиБ)" << std::endl;
+    }
+}
+
+/**
+ * @brief Замер встроенной отрисовки (и MathGL, если доступна) от числа точек
+ * @param count Наибольшее количество точек
+ */
+void benchRaster(size_t count) {
+    ConeGen generator(1.0, 2.0);
+    generator.setSeed(1);
+    std::vector<point3d> points = makePoints(generator, count);
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "=== Отрисовка 1000x800 ===" << std::endl;
+    for (size_t n = 100000; n <= count; n *= 10) {
+        ConeRaster raster;
+        double t0 = now();
+        raster.render(points.data(), n, generator, 1);
+        double one = now() - t0;
+        t0 = now();
+        raster.render(points.data(), n, generator, cores);
+        double all = now() - t0;
+        t0 = now();
+        raster.writePNG("bench_raster.png");
+        double png = now() - t0;
+        std::cout << n << " точек: 1 поток " << one << " с, " << cores << " потоков " << all
+                  << " с, запись PNG " << png << " с" << std::endl;
+
+#ifdef HAVE_MGL
+        t0 = now();
+        mglData x(n), y(n), z(n);
+        for (size_t i = 0; i < n; ++i) {
+            x.a[i] = points[i].x;
+            y.a[i] = points[i].y;
+            z.a[i] = points[i].z;
+        }
+        mglGraph gr;
+        gr.SetSize(1000, 800);
+        gr.SetRange('x', -3, 3);
+        gr.SetRange('y', -3, 3);
+        gr.SetRange('z', -3, 3);
+        gr.Rotate(60, 40);
+        gr.Plot(x, y, z, " r.");
+        gr.WritePNG("bench_mgl.png");
+        std::cout << "    MathGL (Plot + WritePNG): " << now() - t0 << " с" << std::endl;
+        std::remove("bench_mgl.png");
+#endif
+    }
+    std::remove("bench_raster.png");
+}
+
+/**
+ * @brief Замер загрузки файла точек в формате main.cpp
+ * @param count Количество точек
+ */
+void benchLoad(size_t count) {
+    const std::string filename = "bench_points.txt";
+    ConeGen generator(1.0, 2.0);
+    generator.setSeed(1);
+    {
+        // Тот же вывод, что в пункте меню 2, и одна испорченная строка
+        std::ofstream file(filename);
+        point3d p;
+        for (size_t i = 0; i < count; ++i) {
+            generator.rndAt(&p, i);
+            file << p.x << " " << p.y << " " << p.z << "\n";
+            if (i == count / 2) file << "1.0 oops 2.0\n";
+        }
+    }
+    std::ifstream probe(filename, std::ios::ate);
+    double megabytes = probe.tellg() / 1e6;
+    std::cout << "=== Загрузка " << count << " точек (" << megabytes << " МБ) ===" << std::endl;
+
+    double t0 = now();
+    std::vector<point3d> streamed;
+    {
+        std::ifstream file(filename);
+        double x, y, z;
+        while (file >> x >> y >> z) streamed.push_back(point3d(x, y, z));
+    }
+    double tStream = now() - t0;
+    std::cout << "std::ifstream >>: " << tStream << " с, " << streamed.size()
+              << " точек (останавливается на первой ошибке)" << std::endl;
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads : {1u, cores}) {
+        std::vector<point3d> points;
+        t0 = now();
+        LoadResult result = PointLoader::load(filename, points, threads);
+        double t = now() - t0;
+        std::cout << "PointLoader, потоков " << threads << ": " << t << " с (" << megabytes / t
+                  << " МБ/с), " << points.size() << " точек, ошибок " << result.badLines;
+        if (!result.errors.empty()) std::cout << " (строка " << result.errors[0].line << ")";
+        std::cout << ", ускорение " << tStream / t << "x" << std::endl;
+        if (threads == cores) break;
+    }
+    std::remove(filename.c_str());
+}
+
+/**
+ * @brief Замер генерации в части конуса, отсеченной параллелепипедом или плоскостью
+ * @param count Количество точек
+ *
+ * Сравнивается с отбором из всего конуса: ConeGen::rndAt и проверка
+ * ConeClip::contains. Доля объема оценивается тем же отбором.
+ */
+void benchClip(size_t count) {
+    ConeGen generator(1.0, 2.0, point3d(0.5, -0.2, 0.1), point3d(0.3, 0.2, 1));
+    generator.setSeed(7);
+    point3d axisPoint = generator.getCenter() + generator.getNormal() * 0.5;
+
+    std::cout << "=== Отсеченный конус, " << count << " точек ===" << std::endl;
+    std::cout << "область              доля объема  принято  ConeClip, млн/с  отбор, млн/с"
+                 "  ускорение  смещение среднего  отказов rndAt" << std::endl;
+
+    struct Case {
+        const char* name;
+        double half;   ///< Половина стороны куба (0 - плоскость)
+        point3d shift; ///< Сдвиг центра куба от точки на оси
+    };
+    const Case cases[] = {
+        {"куб 4.0 (весь)", 2.0, point3d()},
+        {"куб 1.0", 0.5, point3d()},
+        {"куб 0.4", 0.2, point3d(0.3, 0, 0)},
+        {"куб 0.1", 0.05, point3d(0, 0.5, 0.3)},
+        {"куб 0.03", 0.015, point3d(0.4, 0.4, 0)},
+        {"плоскость", 0, point3d()},
+    };
+    for (const Case& c : cases) {
+        ConeClip clip(generator);
+        if (c.half > 0) {
+            point3d mid = axisPoint + c.shift;
+            point3d h(c.half, c.half, c.half);
+            clip.addBox(mid - h, mid + h);
+        } else {
+            clip.addPlane(point3d(0, 0, 1.6), point3d(0.2, -0.1, 1));
+        }
+        if (!clip.prepare()) {
+            std::cout << c.name << ": область пуста" << std::endl;
+            continue;
+        }
+
+        point3d p, sumClip, sumNaive;
+        uint64_t attempts = 0;
+        size_t accepted = 0;
+        double t0 = now();
+        for (size_t i = 0; i < count; ++i) {
+            // false - исчерпан предел попыток, p не изменена
+            if (clip.rndAt(&p, i, &attempts)) {
+                sumClip = sumClip + p;
+                ++accepted;
+            }
+        }
+        double tClip = now() - t0;
+
+        size_t hits = 0;
+        t0 = now();
+        for (size_t i = 0; i < count; ++i) {
+            generator.rndAt(&p, i);
+            if (clip.contains(p)) {
+                sumNaive = sumNaive + p;
+                ++hits;
+            }
+        }
+        double tNaive = now() - t0;
+
+        double fraction = double(hits) / count;
+        double clipRate = accepted / tClip / 1e6;
+        double naiveRate = hits / tNaive / 1e6;
+        double shift = hits > 0 && accepted > 0
+                           ? (sumClip / double(accepted) - sumNaive / double(hits)).length()
+                           : 0;
+        std::printf("%-20s %11.3g  %6.1f%%  %15.2f  %12.3g  %8.0fx  %.2e  %zu\n", c.name, fraction,
+                    100.0 * accepted / attempts, clipRate, naiveRate, clipRate / naiveRate, shift,
+                    count - accepted);
+    }
+}
+
+/// Конус с размерами времени компиляции для benchKernel
+struct BenchCone {
+    static constexpr double radius = 1.0;
+    static constexpr double height = 2.0;
+};
+
+/**
+ * @brief Замер скорости ядра генерации
+ * @param name Подпись строки
+ * @param fn Генерация count точек в массив
+ * @param count Количество точек
+ * @param reference Эталонные точки ConeGen::rndAt (проверка совпадения бит в бит)
+ * @return Миллионов точек в секунду (лучший из трех запусков)
+ */
+template <typename F>
+double kernelRate(const char* name, F fn, size_t count, const std::vector<point3d>& reference) {
+    std::vector<point3d> points(count);
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        double t0 = now();
+        fn(points.data());
+        best = std::max(best, count / (now() - t0) / 1e6);
+    }
+    bool same = std::memcmp(points.data(), reference.data(), count * sizeof(point3d)) == 0;
+    std::cout << name << ": " << best << " млн точек/с, "
+              << (same ? "совпадает с rndAt" : "ОТЛИЧАЕТСЯ от rndAt") << std::endl;
+    return best;
+}
+
+/**
+ * @brief Замер специализированного ядра против общего пути через базис
+ * @param count Количество точек
+ */
+void benchKernel(size_t count) {
+    ConeGen generator(1.0, 2.0, point3d(0.5, -0.2, 0.1));
+    generator.setSeed(1);
+    std::vector<point3d> reference = makePoints(generator, count);
+
+    std::cout << "=== Ядро генерации, нормаль (0,0,1), " << count << " точек ===" << std::endl;
+    auto generic = generator.kernel<AXIS_ARBITRARY>();
+    auto axial = generator.kernel<AXIS_POS_Z>();
+    auto fixed = generator.kernel<AXIS_POS_Z, BenchCone>();
+    double base = kernelRate("ConeKernel<ARBITRARY> (общий, базис)", [&](point3d* out) {
+        generic.generate(out, 0, count);
+    }, count, reference);
+    kernelRate("ConeGen::rndAt (выбор ядра по getAxis)", [&](point3d* out) {
+        for (size_t i = 0; i < count; ++i) generator.rndAt(&out[i], i);
+    }, count, reference);
+    double rate = kernelRate("ConeKernel<POS_Z>", [&](point3d* out) {
+        axial.generate(out, 0, count);
+    }, count, reference);
+    std::cout << "  ускорение " << rate / base << "x" << std::endl;
+    rate = kernelRate("ConeKernel<POS_Z, constexpr 1 x 2>", [&](point3d* out) {
+        fixed.generate(out, 0, count);
+    }, count, reference);
+    std::cout << "  ускорение " << rate / base << "x" << std::endl;
+}
+
+/**
+ * @brief Основная функция замеров
+ * @param argc Число аргументов
+ * @param argv Аргументы: режим и число точек
+ * @return Код завершения
+ */
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    size_t count = argc > 2 ? std::stoull(argv[2]) : 10000000;
+
+    if (mode == "morton") {
+        benchMorton(count);
+    } else if (mode == "density") {
+        benchDensity(count);
+    } else if (mode == "raster") {
+        benchRaster(count);
+    } else if (mode == "load") {
+        benchLoad(count);
+    } else if (mode == "clip") {
+        benchClip(count);
+    } else if (mode == "kernel") {
+        benchKernel(count);
+    } else {
+        std::cout << "Использование: bench <morton|density|raster|load|clip|kernel> [число точек]" << std::endl;
+        return 1;
+    }
+    return 0;
+}
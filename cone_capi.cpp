@@ -0,0 +1,104 @@
+/**
+ * @file cone_capi.cpp
+ * @brief Реализация C ABI библиотеки libcone.so поверх ConeGen
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+ #include "cone_capi.h"
+ #include "cone_gen.h"
+ #include <new>
+
+ /**
+  * @brief Внутреннее представление непрозрачного дескриптора
+  */
+ struct cone_gen {
+     ConeGen gen; ///< Генератор, которому делегируются все вызовы
+ };
+
+ /**
+  * @brief Записывает точки в буфер заданной раскладки и типа
+  * @tparam T Тип элементов буфера (float или double)
+  * @param gen Генератор
+  * @param first Номер первой точки
+  * @param count Число точек
+  * @param out Буфер
+  * @param soa true - раскладка SoA, false - AoS
+  */
+ template <typename T>
+ static void fill(const ConeGen& gen, uint64_t first, uint64_t count, T* out, bool soa) {
+     point3d p;
+     for (uint64_t i = 0; i < count; ++i) {
+         gen.rndAt(&p, first + i);
+         if (soa) {
+             out[i] = static_cast<T>(p.x);
+             out[count + i] = static_cast<T>(p.y);
+             out[2 * count + i] = static_cast<T>(p.z);
+         } else {
+             out[3 * i] = static_cast<T>(p.x);
+             out[3 * i + 1] = static_cast<T>(p.y);
+             out[3 * i + 2] = static_cast<T>(p.z);
+         }
+     }
+ }
+
+ int cone_abi_version(void) {
+     return CONE_ABI_VERSION;
+ }
+
+ cone_gen* cone_gen_create(double radius, double height) {
+     return new (std::nothrow) cone_gen{ConeGen(radius, height)};
+ }
+
+ void cone_gen_destroy(cone_gen* gen) {
+     delete gen;
+ }
+
+ int cone_gen_set_params(cone_gen* gen, double radius, double height,
+                         double cx, double cy, double cz,
+                         double nx, double ny, double nz) {
+     if (gen == nullptr) return CONE_EINVAL;
+     gen->gen.setParams(radius, height, point3d(cx, cy, cz), point3d(nx, ny, nz));
+     return CONE_OK;
+ }
+
+ int cone_gen_get_params(const cone_gen* gen, double* out) {
+     if (gen == nullptr || out == nullptr) return CONE_EINVAL;
+     point3d c = gen->gen.getCenter();
+     point3d n = gen->gen.getNormal();
+     out[0] = gen->gen.getRadius();
+     out[1] = gen->gen.getHeight();
+     out[2] = c.x; out[3] = c.y; out[4] = c.z;
+     out[5] = n.x; out[6] = n.y; out[7] = n.z;
+     return CONE_OK;
+ }
+
+ int cone_gen_set_seed(cone_gen* gen, uint64_t seed) {
+     if (gen == nullptr) return CONE_EINVAL;
+     gen->gen.setSeed(seed);
+     return CONE_OK;
+ }
+
+ int cone_gen_rotate(cone_gen* gen, double ax, double ay, double az, double angle) {
+     if (gen == nullptr) return CONE_EINVAL;
+     gen->gen.rotate(point3d(ax, ay, az), angle);
+     return CONE_OK;
+ }
+
+ int cone_gen_generate(const cone_gen* gen, uint64_t first, uint64_t count,
+                       void* buffer, int layout, int dtype) {
+     if (gen == nullptr || (buffer == nullptr && count > 0)) return CONE_EINVAL;
+     if (layout != CONE_LAYOUT_AOS && layout != CONE_LAYOUT_SOA) return CONE_EINVAL;
+
+     bool soa = layout == CONE_LAYOUT_SOA;
+     switch (dtype) {
+         case CONE_DTYPE_F64:
+             fill(gen->gen, first, count, static_cast<double*>(buffer), soa);
+             return CONE_OK;
+         case CONE_DTYPE_F32:
+             fill(gen->gen, first, count, static_cast<float*>(buffer), soa);
+             return CONE_OK;
+         default:
+             return CONE_EINVAL;
+     }
+ }
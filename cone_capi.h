@@ -0,0 +1,131 @@
+/**
+ * @file cone_capi.h
+ * @brief C ABI библиотеки libcone.so для вызова генератора из других языков
+ * @author Perevozchikov M
+ * @date 2025
+ *
+ * @details
+ * Интерфейс на чистом C: непрозрачный дескриптор, только POD-аргументы,
+ * без исключений через границу. Предназначен для ctypes/cffi - NumPy
+ * передает указатель на свой массив, и точки пишутся прямо в него.
+ *
+ * Сборка:
+ * @code
+ * g++ -std=c++17 -O2 -shared -fPIC -fvisibility=hidden -o libcone.so \
+ *     cone_capi.cpp cone_gen.cpp density.cpp point3d.cpp
+ * @endcode
+ */
+
+#ifndef CONE_CAPI_H
+#define CONE_CAPI_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Экспорт символа из libcone.so (остальные символы скрыты)
+#define CONE_API __attribute__((visibility("default")))
+
+/// Версия ABI; меняется только при несовместимых изменениях
+#define CONE_ABI_VERSION 1
+
+/// Непрозрачный дескриптор генератора
+typedef struct cone_gen cone_gen;
+
+/// Раскладка выходного буфера
+enum cone_layout {
+    CONE_LAYOUT_AOS = 0, ///< x0 y0 z0 x1 y1 z1 ... (массив count x 3)
+    CONE_LAYOUT_SOA = 1  ///< x0 x1 ... y0 y1 ... z0 z1 ... (массив 3 x count)
+};
+
+/// Тип элементов выходного буфера
+enum cone_dtype {
+    CONE_DTYPE_F64 = 0, ///< double
+    CONE_DTYPE_F32 = 1  ///< float
+};
+
+/// Коды возврата
+enum cone_status {
+    CONE_OK = 0,          ///< Успех
+    CONE_EINVAL = -1,     ///< Неверный аргумент (нулевой указатель, неизвестный тип)
+    CONE_ENOMEM = -2      ///< Не удалось выделить память
+};
+
+/**
+ * @brief Возвращает версию ABI библиотеки
+ * @return CONE_ABI_VERSION, с которой собрана библиотека
+ */
+CONE_API int cone_abi_version(void);
+
+/**
+ * @brief Создает генератор с осью (0,0,1) и центром основания в начале координат
+ * @param radius Радиус конуса
+ * @param height Высота конуса
+ * @return Дескриптор или NULL при нехватке памяти
+ */
+CONE_API cone_gen* cone_gen_create(double radius, double height);
+
+/**
+ * @brief Уничтожает генератор
+ * @param gen Дескриптор (NULL допустим)
+ */
+CONE_API void cone_gen_destroy(cone_gen* gen);
+
+/**
+ * @brief Устанавливает параметры конуса (как ConeGen::setParams)
+ * @param gen Дескриптор
+ * @param radius Радиус
+ * @param height Высота
+ * @param cx,cy,cz Центр основания
+ * @param nx,ny,nz Нормаль (нормализуется)
+ * @return CONE_OK или CONE_EINVAL
+ */
+CONE_API int cone_gen_set_params(cone_gen* gen, double radius, double height,
+                                 double cx, double cy, double cz,
+                                 double nx, double ny, double nz);
+
+/**
+ * @brief Возвращает параметры конуса
+ * @param gen Дескриптор
+ * @param out Массив из 8 double: radius, height, cx, cy, cz, nx, ny, nz
+ * @return CONE_OK или CONE_EINVAL
+ */
+CONE_API int cone_gen_get_params(const cone_gen* gen, double* out);
+
+/**
+ * @brief Устанавливает зерно генератора (как ConeGen::setSeed)
+ * @param gen Дескриптор
+ * @param seed Зерно
+ * @return CONE_OK или CONE_EINVAL
+ */
+CONE_API int cone_gen_set_seed(cone_gen* gen, uint64_t seed);
+
+/**
+ * @brief Вращает конус вокруг оси (как ConeGen::rotate)
+ * @param gen Дескриптор
+ * @param ax,ay,az Ось вращения
+ * @param angle Угол в радианах
+ * @return CONE_OK или CONE_EINVAL
+ */
+CONE_API int cone_gen_rotate(cone_gen* gen, double ax, double ay, double az, double angle);
+
+/**
+ * @brief Генерирует точки с номерами [first, first + count) в буфер вызывающего
+ * @param gen Дескриптор
+ * @param first Номер первой точки (см. ConeGen::rndAt)
+ * @param count Число точек
+ * @param buffer Непрерывный буфер на 3 * count элементов типа dtype
+ * @param layout Раскладка (cone_layout)
+ * @param dtype Тип элементов (cone_dtype)
+ * @return CONE_OK или CONE_EINVAL
+ */
+CONE_API int cone_gen_generate(const cone_gen* gen, uint64_t first, uint64_t count,
+                               void* buffer, int layout, int dtype);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,326 @@
+/**
+ * @file cone_clip.cpp
+ * @brief Реализация генерации точек в отсеченной части конуса (класс ConeClip)
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+ #include "cone_clip.h"
+ #include "splitmix.h"
+ #include <algorithm>
+ #include <cmath>
+
+ /// Предел числа предложений на одну точку
+ static const int MAX_ATTEMPTS = 1000;
+
+ /**
+  * @brief Конструктор класса ConeClip
+  * @param generator Генератор конуса
+  * @param slices Число слоев по высоте
+  */
+ ConeClip::ConeClip(const ConeGen& generator, size_t slices)
+     : radius(generator.getRadius()), height(generator.getHeight()),
+       center(generator.getCenter()), seed(generator.getSeed()),
+       sliceCount(std::max<size_t>(1, slices)), zMin(0), zMax(0), proposalVolume(0) {
+     generator.getBasis(xAxis, yAxis, zAxis);
+ }
+
+ /**
+  * @brief Оставляет часть конуса в полупространстве n * p <= offset
+  * @param n Нормаль плоскости
+  * @param offset Смещение плоскости
+  */
+ void ConeClip::addHalfSpace(const point3d& n, double offset) {
+     // n * (center + xAxis * x + yAxis * y + zAxis * z) <= offset
+     constraints.push_back({n.dot(xAxis), n.dot(yAxis), n.dot(zAxis), offset - n.dot(center)});
+     slices.clear();
+     pick.reset();
+ }
+
+ /**
+  * @brief Оставляет часть конуса по одну сторону плоскости
+  * @param point Точка плоскости
+  * @param n Нормаль в сторону оставляемой части
+  */
+ void ConeClip::addPlane(const point3d& point, const point3d& n) {
+     addHalfSpace(n * -1, -n.dot(point));
+ }
+
+ /**
+  * @brief Оставляет часть конуса внутри параллелепипеда
+  * @param lo Минимальный угол
+  * @param hi Максимальный угол
+  */
+ void ConeClip::addBox(const point3d& lo, const point3d& hi) {
+     addHalfSpace(point3d(1, 0, 0), hi.x);
+     addHalfSpace(point3d(-1, 0, 0), -lo.x);
+     addHalfSpace(point3d(0, 1, 0), hi.y);
+     addHalfSpace(point3d(0, -1, 0), -lo.y);
+     addHalfSpace(point3d(0, 0, 1), hi.z);
+     addHalfSpace(point3d(0, 0, -1), -lo.z);
+ }
+
+ /**
+  * @brief Вычисляет точные границы сечения области на высоте z
+  * @param z Высота над основанием
+  * @param box Прямоугольник xMin, xMax, yMin, yMax
+  * @return false, если сечение пусто
+  *
+  * @details
+  * Сечение - круг, урезанный полуплоскостями, то есть выпуклая фигура.
+  * Крайняя точка по любой оси - либо крайняя точка круга, либо пересечение
+  * прямой с окружностью, либо пересечение двух прямых. Перебираются все
+  * такие точки, лежащие в сечении.
+  */
+ bool ConeClip::sectionBounds(double z, double box[4]) const {
+     const double rho = std::max(0.0, radius * (1 - z / height));
+     const double tol = 1e-9 * radius;
+     const size_t n = constraints.size();
+
+     std::vector<double> g(n);
+     for (size_t k = 0; k < n; ++k) {
+         const Constraint& q = constraints[k];
+         g[k] = q.e - q.c * z;
+         if (q.a * q.a + q.b * q.b < 1e-24 && g[k] < -tol) return false;
+     }
+
+     bool found = false;
+     auto consider = [&](double x, double y) {
+         if (x * x + y * y > (rho + tol) * (rho + tol)) return;
+         for (size_t k = 0; k < n; ++k) {
+             if (constraints[k].a * x + constraints[k].b * y > g[k] + tol) return;
+         }
+         if (!found) {
+             box[0] = box[1] = x;
+             box[2] = box[3] = y;
+             found = true;
+         }
+         box[0] = std::min(box[0], x);
+         box[1] = std::max(box[1], x);
+         box[2] = std::min(box[2], y);
+         box[3] = std::max(box[3], y);
+     };
+
+     // 1. Крайние точки круга
+     consider(rho, 0);
+     consider(-rho, 0);
+     consider(0, rho);
+     consider(0, -rho);
+
+     for (size_t k = 0; k < n; ++k) {
+         const Constraint& q = constraints[k];
+         double m2 = q.a * q.a + q.b * q.b;
+         if (m2 < 1e-24) continue;
+
+         // 2. Прямая a * x + b * y = g и окружность
+         double dist = g[k] / std::sqrt(m2);
+         if (std::abs(dist) <= rho) {
+             double half = std::sqrt(rho * rho - dist * dist) / std::sqrt(m2);
+             double fx = q.a * g[k] / m2, fy = q.b * g[k] / m2;
+             consider(fx - q.b * half, fy + q.a * half);
+             consider(fx + q.b * half, fy - q.a * half);
+         }
+
+         // 3. Две прямые
+         for (size_t l = k + 1; l < n; ++l) {
+             const Constraint& r = constraints[l];
+             double det = q.a * r.b - r.a * q.b;
+             if (std::abs(det) < 1e-12 * m2) continue;
+             consider((g[k] * r.b - g[l] * q.b) / det, (q.a * g[l] - r.a * g[k]) / det);
+         }
+     }
+     return found;
+ }
+
+ /**
+  * @brief Проверяет, что слой целиком внутри всех полупространств
+  * @param z0 Нижняя граница слоя
+  * @param z1 Верхняя граница слоя
+  * @return true, если ни одна плоскость не режет слой
+  *
+  * Максимум a * x + b * y по кругу радиуса r(z) равен |(a, b)| * r(z);
+  * условие |(a, b)| * r(z) + c * z <= e линейно по z, достаточно краев слоя.
+  */
+ bool ConeClip::sliceWhole(double z0, double z1) const {
+     for (const Constraint& q : constraints) {
+         double m = std::hypot(q.a, q.b);
+         for (double z : {z0, z1}) {
+             if (m * radius * (1 - z / height) + q.c * z > q.e) return false;
+         }
+     }
+     return true;
+ }
+
+ /**
+  * @brief Строит слои и таблицу их выбора
+  * @return false, если область пуста
+  */
+ bool ConeClip::prepare() {
+     slices.clear();
+     pick.reset();
+     proposalVolume = 0;
+     if (!(radius > 0) || !(height > 0)) return false;
+
+     // 1. Диапазон высот по каждой плоскости отдельно:
+     //    -m * R * (1 - z/h) <= e - c * z  <=>  z * (m * R / h + c) <= e + m * R
+     double lo = 0, hi = height;
+     for (const Constraint& q : constraints) {
+         double m = std::hypot(q.a, q.b);
+         double A = m * radius / height + q.c;
+         double B = q.e + m * radius;
+         if (std::abs(A) < 1e-15) {
+             if (B < 0) return false;
+         } else if (A > 0) {
+             hi = std::min(hi, B / A);
+         } else {
+             lo = std::max(lo, B / A);
+         }
+     }
+     if (!(lo < hi)) return false;
+
+     // 2. Плоскости вместе могут сузить диапазон сильнее: ищем высоту с непустым
+     //    сечением и уточняем края делением пополам (проекция выпуклой
+     //    области на ось - отрезок)
+     double box[4];
+     double inside = -1;
+     const size_t probes = 4 * sliceCount;
+     for (size_t i = 0; i < probes && inside < 0; ++i) {
+         double z = lo + (hi - lo) * (i + 0.5) / probes;
+         if (sectionBounds(z, box)) inside = z;
+     }
+     if (inside < 0) return false;
+     if (!sectionBounds(lo, box)) {
+         double out = lo, in = inside;
+         for (int it = 0; it < 64; ++it) {
+             double mid = 0.5 * (out + in);
+             (sectionBounds(mid, box) ? in : out) = mid;
+         }
+         lo = in;
+     }
+     if (!sectionBounds(hi, box)) {
+         double out = hi, in = inside;
+         for (int it = 0; it < 64; ++it) {
+             double mid = 0.5 * (out + in);
+             (sectionBounds(mid, box) ? in : out) = mid;
+         }
+         hi = in;
+     }
+     if (!(lo < hi)) return false;
+     zMin = lo;
+     zMax = hi;
+
+     // 3. Слои: целые - точно, разрезанные - прямоугольник предложения.
+     //    Опорная функция выпуклой области f(z) вогнута, поэтому на слое [a, b]
+     //    с серединой m: f <= f(m) + max(0, f(m) - f(a), f(m) - f(b))
+     const double tol = 1e-9 * radius;
+     std::vector<double> weights(sliceCount);
+     slices.resize(sliceCount);
+     for (size_t j = 0; j < sliceCount; ++j) {
+         Slice& s = slices[j];
+         s.z0 = lo + (hi - lo) * j / sliceCount;
+         s.z1 = j + 1 == sliceCount ? hi : lo + (hi - lo) * (j + 1) / sliceCount;
+         double ra = radius * (1 - s.z0 / height);
+         double rb = radius * (1 - s.z1 / height);
+         s.whole = sliceWhole(s.z0, s.z1);
+         s.xMin = s.yMin = -ra;
+         s.xMax = s.yMax = ra;
+
+         if (s.whole) {
+             weights[j] = M_PI / 3 * (ra * ra + ra * rb + rb * rb) * (s.z1 - s.z0);
+         } else {
+             double ba[4], bm[4], bb[4];
+             if (sectionBounds(s.z0, ba) && sectionBounds(0.5 * (s.z0 + s.z1), bm) &&
+                 sectionBounds(s.z1, bb)) {
+                 double* bound[4] = {&s.xMin, &s.xMax, &s.yMin, &s.yMax};
+                 for (int k = 0; k < 4; ++k) {
+                     // Для минимумов вогнута -f
+                     double sign = k % 2 == 0 ? -1 : 1;
+                     double fa = sign * ba[k], fm = sign * bm[k], fb = sign * bb[k];
+                     double f = fm + std::max({0.0, fm - fa, fm - fb}) + tol;
+                     *bound[k] = sign * std::min(f, ra);
+                 }
+             }
+             weights[j] = std::max(0.0, s.xMax - s.xMin) * std::max(0.0, s.yMax - s.yMin) *
+                          (s.z1 - s.z0);
+         }
+         proposalVolume += weights[j];
+     }
+     if (!(proposalVolume > 0)) {
+         slices.clear();
+         return false;
+     }
+
+     // 4. Выбор слоя: ступени равной ширины, вес ступени - объем предложения
+     pick = DensityTable::fromBins(weights, 0);
+     return true;
+ }
+
+ /**
+  * @brief Генерирует точку области с заданным номером
+  * @param p Указатель на точку
+  * @param index Номер точки
+  * @param attempts Счетчик предложенных точек
+  * @return true, если точка построена
+  */
+ bool ConeClip::rndAt(point3d* p, uint64_t index, uint64_t* attempts) const {
+     if (p == nullptr || slices.empty()) return false;
+
+     // Свой поток на номер: число шагов на точку заранее неизвестно
+     uint64_t key = index;
+     uint64_t state = seed ^ splitmix64(key);
+
+     for (int attempt = 1; attempt <= MAX_ATTEMPTS; ++attempt) {
+         double x = pick->sample(toUnit(splitmix64(state)));
+         const Slice& s = slices[std::min(sliceCount - 1, size_t(x * sliceCount))];
+         double u = toUnit(splitmix64(state));
+         double v = toUnit(splitmix64(state));
+         double w = toUnit(splitmix64(state));
+
+         double lx, ly, lz;
+         if (s.whole) {
+             // Как в ConeGen::sample, но tau = 1 - z/h только из [tau1, tau0]
+             double ta = 1 - s.z0 / height, tb = 1 - s.z1 / height;
+             double tau = std::cbrt(tb * tb * tb + u * (ta * ta * ta - tb * tb * tb));
+             double r = radius * tau * std::sqrt(w);
+             lx = r * std::cos(2 * M_PI * v);
+             ly = r * std::sin(2 * M_PI * v);
+             lz = height * (1 - tau);
+         } else {
+             lz = s.z0 + (s.z1 - s.z0) * u;
+             lx = s.xMin + (s.xMax - s.xMin) * v;
+             ly = s.yMin + (s.yMax - s.yMin) * w;
+             if (!containsLocal(lx, ly, lz)) continue;
+         }
+
+         if (attempts != nullptr) *attempts += attempt;
+         *p = center + xAxis * lx + yAxis * ly + zAxis * lz;
+         return true;
+     }
+     if (attempts != nullptr) *attempts += MAX_ATTEMPTS;
+     return false;
+ }
+
+ /**
+  * @brief Проверяет, лежит ли точка в области
+  * @param p Точка
+  * @return true, если точка внутри
+  */
+ bool ConeClip::contains(const point3d& p) const {
+     point3d d = p - center;
+     return containsLocal(d.dot(xAxis), d.dot(yAxis), d.dot(zAxis));
+ }
+
+ /**
+  * @brief Проверяет локальную точку на принадлежность области
+  * @param x,y,z Локальные координаты
+  * @return true, если точка внутри
+  */
+ bool ConeClip::containsLocal(double x, double y, double z) const {
+     if (z < 0 || z > height) return false;
+     double rho = radius * (1 - z / height);
+     if (x * x + y * y > rho * rho) return false;
+     for (const Constraint& q : constraints) {
+         if (q.a * x + q.b * y + q.c * z > q.e) return false;
+     }
+     return true;
+ }
@@ -0,0 +1,164 @@
+/**
+ * @file cone_clip.h
+ * @brief Заголовочный файл класса ConeClip (точки в части конуса, отсеченной плоскостями)
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef CONE_CLIP_H
+#define CONE_CLIP_H
+
+#include "cone_gen.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Класс для равномерной генерации точек в пересечении конуса с полупространствами
+ *
+ * Область задается конусом генератора и набором полупространств n * p <= d:
+ * параллелепипед со сторонами вдоль осей - это шесть полупространств.
+ * Профили плотности генератора не учитываются - точки равномерны по объему.
+ *
+ * Подготовка (prepare):
+ * 1. Для каждого полупространства аналитически находится диапазон высот z,
+ *    где сечение конуса (круг радиуса r(z)) его задевает: условие
+ *    -|n_xy| * r(z) <= d - n_z * z линейно по z. Диапазоны пересекаются;
+ *    края общего диапазона уточняются делением пополам по точной проверке
+ *    сечения на пустоту.
+ * 2. Диапазон делится на слои. Слой, который не режет ни одна плоскость,
+ *    помечается как целый и генерируется точно, обратной функцией
+ *    распределения, как в ConeGen. Для разрезанного слоя строится
+ *    прямоугольник в плоскости сечения: точные границы сечения на краях
+ *    и в середине слоя расширяются по вогнутости опорной функции
+ *    и ограничиваются кругом. В нем работает отбор с отказами.
+ * 3. Слой выбирается таблицей псевдонимов (DensityTable::fromBins) по объему
+ *    предложения: объем усеченного конуса для целых слоев, прямоугольник
+ *    на толщину - для разрезанных.
+ *
+ * Точка с номером i зависит только от зерна генератора, области и i,
+ * как в ConeGen::rndAt; число отказов у разных номеров разное, поэтому
+ * каждый номер получает свой поток splitmix64.
+ */
+class ConeClip {
+public:
+    /**
+     * @brief Конструктор класса ConeClip
+     * @param generator Генератор конуса (параметры и зерно копируются)
+     * @param slices Число слоев по высоте
+     */
+    explicit ConeClip(const ConeGen& generator, size_t slices = 256);
+
+    /**
+     * @brief Оставляет часть конуса в полупространстве n * p <= offset
+     * @param n Нормаль плоскости (наружу от оставляемой части)
+     * @param offset Смещение плоскости
+     */
+    void addHalfSpace(const point3d& n, double offset);
+
+    /**
+     * @brief Оставляет часть конуса по одну сторону плоскости
+     * @param point Точка плоскости
+     * @param n Нормаль плоскости (в сторону оставляемой части)
+     */
+    void addPlane(const point3d& point, const point3d& n);
+
+    /**
+     * @brief Оставляет часть конуса внутри параллелепипеда со сторонами вдоль осей
+     * @param lo Минимальный угол
+     * @param hi Максимальный угол
+     */
+    void addBox(const point3d& lo, const point3d& hi);
+
+    /**
+     * @brief Строит слои и таблицу их выбора
+     * @return false, если область пуста (или тоньше, чем можно обнаружить)
+     *
+     * Вызывается после добавления всех плоскостей и до rndAt.
+     */
+    bool prepare();
+
+    /**
+     * @brief Генерирует точку области с заданным номером
+     * @param p Указатель на точку для заполнения координатами
+     * @param index Номер точки
+     * @param attempts Если не nullptr, к нему прибавляется число предложенных точек
+     * @return false, если область не подготовлена или все попытки отвергнуты
+     */
+    bool rndAt(point3d* p, uint64_t index, uint64_t* attempts = nullptr) const;
+
+    /**
+     * @brief Проверяет, лежит ли точка в области
+     * @param p Точка
+     * @return true, если точка внутри конуса и всех полупространств
+     */
+    bool contains(const point3d& p) const;
+
+    /**
+     * @brief Возвращает нижнюю границу области по высоте над основанием
+     * @return Высота z от 0 до height
+     */
+    double getAxialMin() const { return zMin; }
+
+    /**
+     * @brief Возвращает верхнюю границу области по высоте над основанием
+     * @return Высота z от 0 до height
+     */
+    double getAxialMax() const { return zMax; }
+
+    /**
+     * @brief Возвращает суммарный объем предложения всех слоев
+     * @return Объем; отношение объема области к нему - ожидаемая доля принятых точек
+     */
+    double getProposalVolume() const { return proposalVolume; }
+
+private:
+    /// Полупространство a * x + b * y + c * z <= e в локальных координатах конуса
+    struct Constraint {
+        double a, b, c, e;
+    };
+
+    /// Слой [z0, z1] и его область предложения
+    struct Slice {
+        double z0, z1;                 ///< Границы слоя по высоте
+        double xMin, xMax, yMin, yMax; ///< Прямоугольник предложения в сечении
+        bool whole;                    ///< Слой не разрезан - точная генерация
+    };
+
+    double radius;                            ///< Радиус основания
+    double height;                            ///< Высота
+    point3d center;                           ///< Центр основания
+    point3d xAxis, yAxis, zAxis;              ///< Базис конуса (ConeGen::getBasis)
+    uint64_t seed;                            ///< Зерно
+    size_t sliceCount;                        ///< Число слоев
+    std::vector<Constraint> constraints;      ///< Полупространства в локальных координатах
+    std::vector<Slice> slices;                ///< Слои (пусто - не подготовлено)
+    std::shared_ptr<const DensityTable> pick; ///< Выбор слоя по объему предложения
+    double zMin, zMax;                        ///< Границы области по высоте
+    double proposalVolume;                    ///< Сумма объемов предложения
+
+    /**
+     * @brief Вычисляет точные границы сечения области на высоте z
+     * @param z Высота над основанием
+     * @param box Прямоугольник xMin, xMax, yMin, yMax
+     * @return false, если сечение пусто
+     */
+    bool sectionBounds(double z, double box[4]) const;
+
+    /**
+     * @brief Проверяет, что слой целиком внутри всех полупространств
+     * @param z0 Нижняя граница слоя
+     * @param z1 Верхняя граница слоя
+     * @return true, если ни одна плоскость не режет слой
+     */
+    bool sliceWhole(double z0, double z1) const;
+
+    /**
+     * @brief Проверяет локальную точку на принадлежность области
+     * @param x,y,z Локальные координаты
+     * @return true, если точка в конусе и во всех полупространствах
+     */
+    bool containsLocal(double x, double y, double z) const;
+};
+
+#endif
@@ -21,10 +21,12 @@
   * @param n Нормаль конуса
   */
  ConeGen::ConeGen(double r, double h, const point3d& c, const point3d& n) 
-     : radius(r), height(h), center(c), normal(n.normalize()) {}
+     : radius(r), height(h), center(c), normal(n.normalize()), seed(0) {
+     updateBasis();
+ }
  
  /**
-  * @brief Генерирует случайную точку внутри конуса с равномерным распределением
+  * @brief Генерирует случайную точку внутри конуса (равномерно или по профилям плотности)
   * @param p Указатель на точку для заполнения координатами
   * 
   * @details
@@ -37,35 +39,104 @@
      if (p == nullptr) return;
  
      static std::mt19937 gen(time(0));
-     
-     // УЛУЧШЕННОЕ РАСПРЕДЕЛЕНИЕ: учитываем объемный элемент
-     // Плотность вероятности по z: p(z) ~ (1 - z/h)^2
      std::uniform_real_distribution<> distU(0, 1);
+ 
      double u = distU(gen);
-     
-     // Преобразование для равномерного распределения по объему
-     double z = height * (1 - std::cbrt(u)); // Обратное преобразование
-     
-     // Максимальный радиус на высоте z
-     double maxRadius = radius * (1 - z / height);
+     double v = distU(gen);
+     double w = distU(gen);
+     *p = sample(u, v, w);
+ }
  
-     // Генерация точки в круге (равномерно по площади)
-     std::uniform_real_distribution<> distAngle(0, 2 * M_PI);
-     double angle = distAngle(gen);
+ /**
+  * @brief Генерирует точку с заданным глобальным номером
+  * @param p Указатель на точку для заполнения координатами
+  * @param index Номер точки в глобальной последовательности
+  * 
+  * @details
+  * Поток случайных чисел и переход к номеру - coneUniformsAt (cone_kernel.h),
+  * общий с ConeKernel.
+  */
+ void ConeGen::rndAt(point3d* p, uint64_t index) const {
+     if (p == nullptr) return;
+ 
+     double u, v, w;
+     coneUniformsAt(seed, index, u, v, w);
+     *p = sample(u, v, w);
+ }
+ 
+ /**
+  * @brief Строит точку конуса по трем равномерным числам из [0, 1)
+  * @param u Число для высоты
+  * @param v Число для угла
+  * @param w Число для радиуса
+  * @return Глобальные координаты точки
+  */
+ point3d ConeGen::sample(double u, double v, double w) const {
+     // УЛУЧШЕННОЕ РАСПРЕДЕЛЕНИЕ: учитываем объемный элемент
+     // Плотность вероятности по z: p(z) ~ (1 - z/h)^2
+     // Преобразование для равномерного распределения по объему;
+     // при заданном профиле - по таблице (расстояние от вершины в долях высоты)
+     double tau = axialTable ? axialTable->sample(u) : std::cbrt(u);
      
-     // РАВНОМЕРНОЕ РАСПРЕДЕЛЕНИЕ В КРУГЕ
-     std::uniform_real_distribution<> distR(0, 1);
-     double r_val = maxRadius * std::sqrt(distR(gen)); // sqrt для равномерности в круге
- 
-     // Локальные координаты (z вдоль нормали)
-     point3d local(
-         r_val * std::cos(angle),
-         r_val * std::sin(angle), 
-         z
-     );
+     // РАВНОМЕРНОЕ РАСПРЕДЕЛЕНИЕ В КРУГЕ (sqrt для равномерности по площади)
+     double s = radialTable ? radialTable->sample(w) : std::sqrt(w);
+ 
+     // Локальные координаты (z вдоль нормали) - общий код с ConeKernel
+     point3d local = coneLocal(radius, height, tau, s, v);
  
      // Преобразование в глобальные координаты
-     *p = localToGlobal(local);
+     return localToGlobal(local);
+ }
+ 
+ /**
+  * @brief Задает профиль плотности вдоль оси функцией
+  * @param density Плотность A(t)
+  * @param tableSize Число узлов таблицы
+  * @param interpolation Вид интерполяции
+  * 
+  * Таблица строится по расстоянию от вершины tau = 1 - t с якобианом tau^2
+  * (площадь сечения).
+  */
+ void ConeGen::setAxialDensity(const std::function<double(double)>& density, size_t tableSize,
+                               DensityTable::Interpolation interpolation) {
+     axialTable = DensityTable::fromFunction(
+         [density](double tau) { return density(1 - tau); }, 2, tableSize, interpolation);
+ }
+ 
+ /**
+  * @brief Задает ступенчатый профиль плотности вдоль оси
+  * @param weights Плотность на слоях от основания к вершине
+  */
+ void ConeGen::setAxialDensity(const std::vector<double>& weights) {
+     // Таблица ведется от вершины - переворачиваем слои
+     axialTable = DensityTable::fromBins(std::vector<double>(weights.rbegin(), weights.rend()), 2);
+ }
+ 
+ /**
+  * @brief Задает профиль плотности по радиусу функцией
+  * @param density Плотность B(s)
+  * @param tableSize Число узлов таблицы
+  * @param interpolation Вид интерполяции
+  */
+ void ConeGen::setRadialDensity(const std::function<double(double)>& density, size_t tableSize,
+                                DensityTable::Interpolation interpolation) {
+     radialTable = DensityTable::fromFunction(density, 1, tableSize, interpolation);
+ }
+ 
+ /**
+  * @brief Задает ступенчатый профиль плотности по радиусу
+  * @param weights Плотность на кольцах от оси к боковой поверхности
+  */
+ void ConeGen::setRadialDensity(const std::vector<double>& weights) {
+     radialTable = DensityTable::fromBins(weights, 1);
+ }
+ 
+ /**
+  * @brief Возвращает равномерную плотность по объему
+  */
+ void ConeGen::clearDensity() {
+     axialTable.reset();
+     radialTable.reset();
  }
  
  /**
@@ -80,6 +151,7 @@
      height = h;
      center = c;
      normal = n.normalize();
+     updateBasis();
  }
  
  /**
@@ -108,6 +180,41 @@
      }
  }
  
+ /**
+  * @brief Загружает параметры конуса из файла
+  * @param filename Имя файла
+  * @return true, если параметры прочитаны
+  */
+ bool ConeGen::loadSet(const std::string& filename) {
+     std::ifstream file(filename);
+     if (!file.is_open()) return false;
+ 
+     double r, h, cx, cy, cz, nx, ny, nz;
+     if (!(file >> r >> h >> cx >> cy >> cz >> nx >> ny >> nz)) return false;
+     setParams(r, h, point3d(cx, cy, cz), point3d(nx, ny, nz));
+     return true;
+ }
+ 
+ /**
+  * @brief Вычисляет ограничивающий параллелепипед конуса
+  * @param lo Минимальный угол
+  * @param hi Максимальный угол
+  */
+ void ConeGen::getBounds(point3d& lo, point3d& hi) const {
+     point3d apex = getApex();
+     point3d ext(
+         radius * std::sqrt(std::max(0.0, 1 - normal.x * normal.x)),
+         radius * std::sqrt(std::max(0.0, 1 - normal.y * normal.y)),
+         radius * std::sqrt(std::max(0.0, 1 - normal.z * normal.z))
+     );
+     lo = point3d(std::min(center.x - ext.x, apex.x),
+                  std::min(center.y - ext.y, apex.y),
+                  std::min(center.z - ext.z, apex.z));
+     hi = point3d(std::max(center.x + ext.x, apex.x),
+                  std::max(center.y + ext.y, apex.y),
+                  std::max(center.z + ext.z, apex.z));
+ }
+ 
  /**
   * @brief Вращает конус вокруг оси на заданный угол
   * @param axis Ось вращения
@@ -120,14 +227,16 @@
      // Вращаем центр основания относительно начала координат
      // Это важно для правильного позиционирования конуса
      center = center.rotate(axis, angle);
+     updateBasis();
  }
  
  /**
-  * @brief Преобразует локальные координаты конуса в глобальные
-  * @param local Локальные координаты (z вдоль нормали)
-  * @return Глобальные координаты
+  * @brief Пересчитывает базис и ориентацию после смены нормали
+  * 
+  * Ориентация определяется точным сравнением: нормаль, лишь близкая к оси
+  * (например, после rotate на 90°), идет общим путем через базис.
   */
- point3d ConeGen::localToGlobal(const point3d& local) const {
+ void ConeGen::updateBasis() {
      // Базовые векторы для локальной системы координат
      point3d z_axis = normal.normalize();
      
@@ -138,11 +247,39 @@
      }
      
      point3d x_axis = z_axis.cross(arbitrary).normalize();
-     point3d y_axis = z_axis.cross(x_axis).normalize();
-     
-     // Преобразование координат
-     return center + 
-            x_axis * local.x + 
-            y_axis * local.y + 
-            z_axis * local.z;
+     basis[0] = x_axis;
+     basis[1] = z_axis.cross(x_axis).normalize();
+     basis[2] = z_axis;
+     axis = coneAxisOf(z_axis);
+ }
+ 
+ /**
+  * @brief Возвращает базис локальной системы координат конуса
+  * @param x_axis Первая ось сечения
+  * @param y_axis Вторая ось сечения
+  * @param z_axis Ось конуса (нормаль)
+  */
+ void ConeGen::getBasis(point3d& x_axis, point3d& y_axis, point3d& z_axis) const {
+     x_axis = basis[0];
+     y_axis = basis[1];
+     z_axis = basis[2];
+ }
+ 
+ /**
+  * @brief Преобразует локальные координаты конуса в глобальные
+  * @param local Локальные координаты (z вдоль нормали)
+  * @return Глобальные координаты
+  * 
+  * Для нормали вдоль оси - перестановка координат из cone_kernel.h.
+  */
+ point3d ConeGen::localToGlobal(const point3d& local) const {
+     switch (axis) {
+         case AXIS_POS_X: return coneToGlobal<AXIS_POS_X>(center, basis, local.x, local.y, local.z);
+         case AXIS_NEG_X: return coneToGlobal<AXIS_NEG_X>(center, basis, local.x, local.y, local.z);
+         case AXIS_POS_Y: return coneToGlobal<AXIS_POS_Y>(center, basis, local.x, local.y, local.z);
+         case AXIS_NEG_Y: return coneToGlobal<AXIS_NEG_Y>(center, basis, local.x, local.y, local.z);
+         case AXIS_POS_Z: return coneToGlobal<AXIS_POS_Z>(center, basis, local.x, local.y, local.z);
+         case AXIS_NEG_Z: return coneToGlobal<AXIS_NEG_Z>(center, basis, local.x, local.y, local.z);
+         default: return coneToGlobal<AXIS_ARBITRARY>(center, basis, local.x, local.y, local.z);
+     }
  }
\ No newline at end of file
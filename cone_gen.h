@@ -9,12 +9,24 @@
 #define CONE_GEN_H
 
 #include "point3d.h"
+#include "density.h"
+#include "cone_kernel.h"
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 /**
  * @brief Класс для генерации случайных точек внутри конуса
  * 
  * Класс генерирует точки, равномерно распределенные внутри заданного конуса.
+ * Можно задать неравномерную плотность вида A(t) * B(s), где t = z/h - высота
+ * над основанием (0 - основание, 1 - вершина), s = r/r_max(z) - относительное
+ * расстояние от оси. Профили A и B компилируются в таблицы DensityTable,
+ * которые хранятся в генераторе и не зависят от радиуса и высоты.
  * Конус задается радиусом основания, высотой, координатами центра основания и нормалью.
  * Нормаль - вектор направления от основания к вершине конуса.
  * 
@@ -29,6 +41,11 @@ private:
     double height;  ///< Высота конуса
     point3d center; ///< Центр основания конуса
     point3d normal; ///< Нормаль конуса (направление от основания к вершине)
+    uint64_t seed;  ///< Зерно детерминированного генератора для rndAt
+    std::shared_ptr<const DensityTable> axialTable;  ///< Профиль вдоль оси (nullptr - равномерный)
+    std::shared_ptr<const DensityTable> radialTable; ///< Профиль по радиусу (nullptr - равномерный)
+    ConeAxis axis;    ///< Ориентация нормали (вдоль оси - перестановка вместо поворота)
+    point3d basis[3]; ///< Базис локальной системы координат (x_axis, y_axis, z_axis)
 
 public:
     /**
@@ -41,14 +58,113 @@ public:
     ConeGen(double r, double h, const point3d& c = point3d(), const point3d& n = point3d(0,0,1));
 
     /**
-     * @brief Генерирует случайную точку внутри конуса с равномерным распределением
+     * @brief Генерирует случайную точку внутри конуса
      * @param p Указатель на точку для заполнения координатами
      * 
-     * Точка генерируется с равномерным распределением внутри объема конуса.
+     * Точка распределена равномерно по объему конуса, а если заданы профили
+     * плотности (setAxialDensity, setRadialDensity) - с плотностью A(t) * B(s).
      * Если указатель nullptr, функция ничего не делает.
      */
     void rnd(point3d* p);
 
+    /**
+     * @brief Генерирует точку с заданным глобальным номером
+     * @param p Указатель на точку для заполнения координатами
+     * @param index Номер точки в глобальной последовательности
+     * 
+     * В отличие от rnd(), результат зависит только от зерна, параметров конуса
+     * и номера точки. Поток случайных чисел (splitmix64) допускает переход
+     * к любому номеру за O(1), поэтому шард k из N, начавший с номера begin,
+     * выдает ровно те же точки, что и один общий запуск.
+     * Если указатель nullptr, функция ничего не делает.
+     */
+    void rndAt(point3d* p, uint64_t index) const;
+
+    /**
+     * @brief Устанавливает зерно детерминированного генератора
+     * @param s Зерно
+     */
+    void setSeed(uint64_t s) { seed = s; }
+
+    /**
+     * @brief Возвращает зерно детерминированного генератора
+     * @return Зерно
+     */
+    uint64_t getSeed() const { return seed; }
+
+    /**
+     * @brief Задает профиль плотности вдоль оси функцией
+     * @param density Плотность A(t), t = z/h: 0 - основание, 1 - вершина
+     * @param tableSize Число узлов таблицы обратной функции распределения
+     * @param interpolation Вид интерполяции таблицы
+     * 
+     * Пример - линейный рост плотности к вершине: [](double t) { return t; }
+     */
+    void setAxialDensity(const std::function<double(double)>& density, size_t tableSize = 256,
+                         DensityTable::Interpolation interpolation = DensityTable::LINEAR);
+
+    /**
+     * @brief Задает ступенчатый профиль плотности вдоль оси
+     * @param weights Плотность на равных слоях от основания к вершине
+     */
+    void setAxialDensity(const std::vector<double>& weights);
+
+    /**
+     * @brief Задает профиль плотности по радиусу функцией
+     * @param density Плотность B(s), s = r/r_max(z): 0 - ось, 1 - боковая поверхность
+     * @param tableSize Число узлов таблицы обратной функции распределения
+     * @param interpolation Вид интерполяции таблицы
+     * 
+     * Пример - гауссов спад от оси: [](double s) { return std::exp(-s * s / 0.08); }
+     */
+    void setRadialDensity(const std::function<double(double)>& density, size_t tableSize = 256,
+                          DensityTable::Interpolation interpolation = DensityTable::LINEAR);
+
+    /**
+     * @brief Задает ступенчатый профиль плотности по радиусу
+     * @param weights Плотность на равных кольцах от оси к боковой поверхности
+     */
+    void setRadialDensity(const std::vector<double>& weights);
+
+    /**
+     * @brief Возвращает равномерную плотность по объему
+     */
+    void clearDensity();
+
+    /**
+     * @brief Проверяет, задана ли неравномерная плотность
+     * @return true, если задан хотя бы один профиль
+     */
+    bool hasDensity() const { return axialTable || radialTable; }
+
+    /**
+     * @brief Возвращает ориентацию конуса
+     * @return Ось, если нормаль в точности направлена вдоль оси, иначе AXIS_ARBITRARY
+     */
+    ConeAxis getAxis() const { return axis; }
+
+    /**
+     * @brief Создает ядро генерации с ориентацией и размерами времени компиляции
+     * @tparam Axis Ориентация (getAxis() или AXIS_ARBITRARY)
+     * @tparam Dims ConeDims или тип с static constexpr radius и height
+     * @return Ядро, выдающее те же точки, что и rndAt без профилей плотности
+     * 
+     * Пример: if (generator.getAxis() == AXIS_POS_Z) {
+     *             auto kernel = generator.kernel<AXIS_POS_Z>(); ... }
+     * 
+     * Ядро верно только для той же оси, без профилей плотности и, при
+     * постоянном Dims, с теми же размерами - это проверяется assert.
+     */
+    template <ConeAxis Axis, typename Dims = ConeDims>
+    ConeKernel<Axis, Dims> kernel() const {
+        assert(Axis == AXIS_ARBITRARY || Axis == axis);
+        assert(!hasDensity());
+        if constexpr (!std::is_same<Dims, ConeDims>::value) {
+            assert(Dims::radius == radius && Dims::height == height);
+        }
+        return ConeKernel<Axis, Dims>(radius, height, center, basis[0], basis[1], basis[2], seed);
+    }
+
     /**
      * @brief Устанавливает параметры конуса
      * @param r Радиус конуса
@@ -70,6 +186,13 @@ public:
      */
     void saveSet(const std::string& filename) const;
 
+    /**
+     * @brief Загружает параметры конуса из файла, записанного saveSet()
+     * @param filename Имя файла
+     * @return true, если прочитаны все 8 чисел; иначе параметры не меняются
+     */
+    bool loadSet(const std::string& filename);
+
     /**
      * @brief Возвращает радиус конуса
      * @return Радиус конуса
@@ -100,6 +223,16 @@ public:
      */
     point3d getApex() const { return center + normal.normalize() * height; }
 
+    /**
+     * @brief Вычисляет ограничивающий параллелепипед конуса со сторонами вдоль осей
+     * @param lo Минимальный угол
+     * @param hi Максимальный угол
+     * 
+     * Круг основания с нормалью n выступает по оси i на radius * sqrt(1 - n_i^2),
+     * к нему добавляется вершина.
+     */
+    void getBounds(point3d& lo, point3d& hi) const;
+
     /**
      * @brief Вращает конус вокруг оси на заданный угол
      * @param axis Ось вращения
@@ -111,7 +244,32 @@ public:
      */
     void rotate(const point3d& axis, double angle);
 
+    /**
+     * @brief Вычисляет базис локальной системы координат конуса
+     * @param x_axis Первая ось сечения
+     * @param y_axis Вторая ось сечения
+     * @param z_axis Ось конуса (нормаль)
+     * 
+     * Точка с локальными координатами (x, y, z) лежит в
+     * center + x_axis * x + y_axis * y + z_axis * z.
+     */
+    void getBasis(point3d& x_axis, point3d& y_axis, point3d& z_axis) const;
+
 private:
+    /**
+     * @brief Пересчитывает базис и ориентацию после смены нормали
+     */
+    void updateBasis();
+
+    /**
+     * @brief Строит точку конуса по трем равномерным числам из [0, 1)
+     * @param u Число для высоты
+     * @param v Число для угла
+     * @param w Число для радиуса
+     * @return Глобальные координаты точки
+     */
+    point3d sample(double u, double v, double w) const;
+
     /**
      * @brief Преобразует локальные координаты конуса в глобальные
      * @param local Локальные координаты (z вдоль нормали)
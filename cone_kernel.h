@@ -0,0 +1,217 @@
+/**
+ * @file cone_kernel.h
+ * @brief Ядро генерации точек конуса с ориентацией и размерами времени компиляции
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef CONE_KERNEL_H
+#define CONE_KERNEL_H
+
+#include "point3d.h"
+#include "splitmix.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief Ориентация конуса
+ *
+ * Для нормали вдоль оси базис ConeGen::getBasis состоит из единичных
+ * векторов осей, и переход в глобальные координаты - перестановка
+ * локальных координат со знаками плюс сдвиг на центр основания.
+ */
+enum ConeAxis {
+    AXIS_POS_X,    ///< Нормаль (1, 0, 0)
+    AXIS_NEG_X,    ///< Нормаль (-1, 0, 0)
+    AXIS_POS_Y,    ///< Нормаль (0, 1, 0)
+    AXIS_NEG_Y,    ///< Нормаль (0, -1, 0)
+    AXIS_POS_Z,    ///< Нормаль (0, 0, 1) - по умолчанию в ConeGen
+    AXIS_NEG_Z,    ///< Нормаль (0, 0, -1)
+    AXIS_ARBITRARY ///< Произвольная нормаль - полный поворот базисом
+};
+
+/**
+ * @brief Определяет ориентацию по нормированной нормали
+ * @param n Нормаль
+ * @return Ось, если нормаль в точности равна единичному вектору оси, иначе AXIS_ARBITRARY
+ */
+inline ConeAxis coneAxisOf(const point3d& n) {
+    if (n.y == 0 && n.z == 0) {
+        if (n.x == 1) return AXIS_POS_X;
+        if (n.x == -1) return AXIS_NEG_X;
+    }
+    if (n.x == 0 && n.z == 0) {
+        if (n.y == 1) return AXIS_POS_Y;
+        if (n.y == -1) return AXIS_NEG_Y;
+    }
+    if (n.x == 0 && n.y == 0) {
+        if (n.z == 1) return AXIS_POS_Z;
+        if (n.z == -1) return AXIS_NEG_Z;
+    }
+    return AXIS_ARBITRARY;
+}
+
+/**
+ * @brief Переводит локальные координаты конуса в глобальные
+ * @tparam Axis Ориентация конуса
+ * @param center Центр основания
+ * @param basis Базис ConeGen::getBasis (читается только для AXIS_ARBITRARY)
+ * @param lx,ly,lz Локальные координаты (lz вдоль нормали)
+ * @return Глобальные координаты
+ *
+ * Перестановки выписаны из базиса ConeGen::getBasis (например, для +Z
+ * это x_axis = (0,1,0), y_axis = (-1,0,0)) и дают те же биты, что и
+ * общая формула center + x_axis * lx + y_axis * ly + z_axis * lz:
+ * слагаемые 0 * l не меняют сумму.
+ */
+template <ConeAxis Axis>
+inline point3d coneToGlobal(const point3d& center, const point3d* basis,
+                            double lx, double ly, double lz) {
+    if constexpr (Axis == AXIS_POS_X) {
+        return point3d(center.x + lz, center.y - ly, center.z + lx);
+    } else if constexpr (Axis == AXIS_NEG_X) {
+        return point3d(center.x - lz, center.y - ly, center.z - lx);
+    } else if constexpr (Axis == AXIS_POS_Y) {
+        return point3d(center.x - ly, center.y + lz, center.z - lx);
+    } else if constexpr (Axis == AXIS_NEG_Y) {
+        return point3d(center.x - ly, center.y - lz, center.z + lx);
+    } else if constexpr (Axis == AXIS_POS_Z) {
+        return point3d(center.x - ly, center.y + lx, center.z + lz);
+    } else if constexpr (Axis == AXIS_NEG_Z) {
+        return point3d(center.x - ly, center.y - lx, center.z - lz);
+    } else {
+        return center + basis[0] * lx + basis[1] * ly + basis[2] * lz;
+    }
+}
+
+/**
+ * @brief Выдает три равномерных числа точки с заданным номером
+ * @param seed Зерно
+ * @param index Номер точки
+ * @param u,v,w Числа из [0, 1) для высоты, угла и радиуса
+ *
+ * Точка с номером i использует выходы 3i, 3i+1, 3i+2 потока splitmix64.
+ * Состояние splitmix64 - счетчик с постоянным шагом, поэтому переход
+ * к номеру i сводится к одному умножению. Общий код ConeGen::rndAt
+ * и ConeKernel::rndAt.
+ */
+inline void coneUniformsAt(uint64_t seed, uint64_t index, double& u, double& v, double& w) {
+    uint64_t state = seed + index * 3 * 0x9E3779B97F4A7C15ULL;
+    u = toUnit(splitmix64(state));
+    v = toUnit(splitmix64(state));
+    w = toUnit(splitmix64(state));
+}
+
+/**
+ * @brief Строит локальные координаты точки конуса
+ * @param radius Радиус основания
+ * @param height Высота
+ * @param tau Расстояние от вершины в долях высоты (равномерно по объему - cbrt(u))
+ * @param s Расстояние от оси в долях r_max(z) (равномерно по площади - sqrt(w))
+ * @param v Равномерное число для угла
+ * @return Локальные координаты (z вдоль нормали)
+ *
+ * Общий код ConeGen::sample и ConeKernel::sample: оба выдают одни и те же
+ * биты, пока пользуются этой функцией.
+ */
+inline point3d coneLocal(double radius, double height, double tau, double s, double v) {
+    double z = height * (1 - tau); // Обратное преобразование
+
+    // Максимальный радиус на высоте z
+    double maxRadius = radius * (1 - z / height);
+
+    // Генерация точки в круге (равномерно по площади)
+    double angle = 2 * M_PI * v;
+    double r_val = maxRadius * s;
+
+    return point3d(r_val * std::cos(angle), r_val * std::sin(angle), z);
+}
+
+/**
+ * @brief Размеры конуса, заданные во время выполнения
+ *
+ * Размеры времени компиляции задаются своим типом с такими же именами
+ * полей, но static constexpr:
+ * @code
+ * struct UnitCone {
+ *     static constexpr double radius = 1.0;
+ *     static constexpr double height = 2.0;
+ * };
+ * ConeKernel<AXIS_POS_Z, UnitCone> kernel = generator.kernel<AXIS_POS_Z, UnitCone>();
+ * @endcode
+ */
+struct ConeDims {
+    double radius; ///< Радиус основания
+    double height; ///< Высота
+};
+
+/**
+ * @brief Ядро равномерной генерации точек конуса
+ * @tparam Axis Ориентация конуса (AXIS_ARBITRARY - любая)
+ * @tparam Dims ConeDims или тип с static constexpr radius и height
+ *
+ * Повторяет ConeGen::rndAt без профилей плотности и выдает те же точки
+ * бит в бит. Ориентация и (при постоянном Dims) размеры известны
+ * компилятору: поворот базисом вырождается в перестановку со сдвигом,
+ * константы сворачиваются. Создается через ConeGen::kernel.
+ */
+template <ConeAxis Axis, typename Dims = ConeDims>
+class ConeKernel {
+private:
+    Dims dims;        ///< Размеры
+    point3d center;   ///< Центр основания
+    point3d basis[3]; ///< Базис (только для AXIS_ARBITRARY)
+    uint64_t seed;    ///< Зерно
+
+public:
+    /**
+     * @brief Конструктор ядра
+     * @param radius,height Размеры (игнорируются для постоянного Dims)
+     * @param c Центр основания
+     * @param x_axis,y_axis,z_axis Базис конуса
+     * @param s Зерно
+     */
+    ConeKernel(double radius, double height, const point3d& c, const point3d& x_axis,
+               const point3d& y_axis, const point3d& z_axis, uint64_t s)
+        : dims(), center(c), basis{x_axis, y_axis, z_axis}, seed(s) {
+        if constexpr (std::is_same<Dims, ConeDims>::value) dims = ConeDims{radius, height};
+    }
+
+    /**
+     * @brief Строит точку по трем равномерным числам (как ConeGen::sample)
+     * @param u Число для высоты
+     * @param v Число для угла
+     * @param w Число для радиуса
+     * @return Глобальные координаты точки
+     */
+    point3d sample(double u, double v, double w) const {
+        point3d local = coneLocal(dims.radius, dims.height, std::cbrt(u), std::sqrt(w), v);
+        return coneToGlobal<Axis>(center, basis, local.x, local.y, local.z);
+    }
+
+    /**
+     * @brief Генерирует точку с заданным глобальным номером (как ConeGen::rndAt)
+     * @param p Указатель на точку
+     * @param index Номер точки
+     */
+    void rndAt(point3d* p, uint64_t index) const {
+        if (p == nullptr) return;
+        double u, v, w;
+        coneUniformsAt(seed, index, u, v, w);
+        *p = sample(u, v, w);
+    }
+
+    /**
+     * @brief Генерирует точки с номерами [first, first + count)
+     * @param out Массив на count точек
+     * @param first Номер первой точки
+     * @param count Число точек
+     */
+    void generate(point3d* out, uint64_t first, size_t count) const {
+        for (size_t i = 0; i < count; ++i) rndAt(&out[i], first + i);
+    }
+};
+
+#endif
@@ -0,0 +1,470 @@
+/**
+ * @file cone_shard.cpp
+ * @brief Реализация шардированной генерации, проверки и склейки шардов
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+ #include "cone_shard.h"
+ #include <algorithm>
+ #include <cerrno>
+ #include <cstdio>
+ #include <cstring>
+ #include <filesystem>
+ #include <fstream>
+ #include <iomanip>
+ #include <limits>
+ #include <sstream>
+ #include <fcntl.h>
+ #include <unistd.h>
+
+ namespace fs = std::filesystem;
+
+ /// Размер одной точки в двоичном файле шарда (x, y, z)
+ static const uint64_t POINT_BYTES = 3 * sizeof(double);
+
+ /// Число точек, генерируемых за один проход перед записью
+ static const size_t CHUNK_POINTS = 1 << 16;
+
+ /**
+  * @brief Сохраняет манифест в файл
+  * @param filename Имя файла
+  * @return true, если файл записан
+  */
+ bool ShardManifest::save(const std::string& filename) const {
+     std::ofstream file(filename);
+     if (!file.is_open()) return false;
+
+     // Точность max_digits10 - чтобы параметры читались обратно без потерь
+     file << std::setprecision(std::numeric_limits<double>::max_digits10);
+     file << "format=cone-shard 1\n"
+          << "radius=" << radius << "\n"
+          << "height=" << height << "\n"
+          << "center=" << center.x << " " << center.y << " " << center.z << "\n"
+          << "normal=" << normal.x << " " << normal.y << " " << normal.z << "\n"
+          << "seed=" << seed << "\n"
+          << "total=" << total << "\n"
+          << "shard=" << shard << "\n"
+          << "shards=" << shards << "\n"
+          << "begin=" << begin << "\n"
+          << "end=" << end << "\n"
+          << "checksum=" << std::hex << std::setw(16) << std::setfill('0') << checksum
+          << std::dec << "\n";
+     for (const ShardPart& part : parts) {
+         file << "part=" << part.begin << " " << part.end << " " << part.file << "\n";
+     }
+     return file.good();
+ }
+
+ /**
+  * @brief Загружает манифест из файла
+  * @param filename Имя файла
+  * @param error Описание ошибки, если загрузка не удалась
+  * @return true, если манифест прочитан полностью
+  *
+  * Пути частей приводятся к путям относительно текущего каталога.
+  */
+ bool ShardManifest::load(const std::string& filename, std::string& error) {
+     std::ifstream file(filename);
+     if (!file.is_open()) {
+         error = filename + ": не удается открыть манифест";
+         return false;
+     }
+
+     fs::path dir = fs::path(filename).parent_path();
+     path = filename;
+     parts.clear();
+     int found = 0;
+     std::string line;
+     while (std::getline(file, line)) {
+         size_t eq = line.find('=');
+         if (eq == std::string::npos) continue;
+         std::string key = line.substr(0, eq);
+         std::istringstream value(line.substr(eq + 1));
+
+         if (key == "format") {
+             std::string name;
+             int version = 0;
+             value >> name >> version;
+             if (name != "cone-shard" || version != 1) {
+                 error = filename + ": неизвестный формат манифеста";
+                 return false;
+             }
+             continue;
+         }
+         if      (key == "radius")   value >> radius;
+         else if (key == "height")   value >> height;
+         else if (key == "center")   value >> center.x >> center.y >> center.z;
+         else if (key == "normal")   value >> normal.x >> normal.y >> normal.z;
+         else if (key == "seed")     value >> seed;
+         else if (key == "total")    value >> total;
+         else if (key == "shard")    value >> shard;
+         else if (key == "shards")   value >> shards;
+         else if (key == "begin")    value >> begin;
+         else if (key == "end")      value >> end;
+         else if (key == "checksum") value >> std::hex >> checksum;
+         else if (key == "part") {
+             ShardPart part;
+             value >> part.begin >> part.end;
+             value >> std::ws;
+             std::getline(value, part.file);
+             if (value.fail() || part.file.empty()) {
+                 error = filename + ": неверная часть " + line.substr(eq + 1);
+                 return false;
+             }
+             part.file = (dir / part.file).lexically_normal().string();
+             parts.push_back(part);
+             continue;
+         } else {
+             continue;
+         }
+         if (value.fail()) {
+             error = filename + ": неверное значение ключа " + key;
+             return false;
+         }
+         ++found;
+     }
+
+     if (found < 11 || parts.empty()) {
+         error = filename + ": манифест неполный";
+         return false;
+     }
+     return true;
+ }
+
+ /**
+  * @brief Проверяет, что два манифеста описывают один и тот же запуск
+  * @param other Второй манифест
+  * @return true, если совпадают параметры конуса, зерно и общее число точек
+  */
+ bool ShardManifest::sameRun(const ShardManifest& other) const {
+     return radius == other.radius && height == other.height &&
+            center.x == other.center.x && center.y == other.center.y &&
+            center.z == other.center.z && normal.x == other.normal.x &&
+            normal.y == other.normal.y && normal.z == other.normal.z &&
+            seed == other.seed && total == other.total;
+ }
+
+ /**
+  * @brief Конструктор класса ConeShard
+  * @param gen Генератор конуса (параметры и зерно)
+  * @param total Общее число точек во всех шардах
+  * @param shard Номер шарда
+  * @param shards Число шардов
+  */
+ ConeShard::ConeShard(const ConeGen& gen, uint64_t total, uint64_t shard, uint64_t shards)
+     : generator(gen), total(total), shard(shard), shards(shards == 0 ? 1 : shards) {}
+
+ /**
+  * @brief Генерирует шард и записывает prefix.bin и prefix.manifest
+  * @param prefix Префикс имен файлов
+  * @return true, если оба файла записаны
+  */
+ bool ConeShard::write(const std::string& prefix) const {
+     // Манифест описывает только равномерный конус - иначе verify и merge
+     // приняли бы шарды с разными профилями за один запуск
+     if (shard >= shards || generator.hasDensity()) return false;
+
+     std::string dataName = prefix + ".bin";
+     std::ofstream data(dataName, std::ios::binary);
+     if (!data.is_open()) return false;
+
+     ShardManifest manifest;
+     manifest.radius = generator.getRadius();
+     manifest.height = generator.getHeight();
+     manifest.center = generator.getCenter();
+     manifest.normal = generator.getNormal();
+     manifest.seed = generator.getSeed();
+     manifest.total = total;
+     manifest.shard = shard;
+     manifest.shards = shards;
+     manifest.begin = begin();
+     manifest.end = end();
+     manifest.checksum = checksum(nullptr, 0);
+
+     // Генерируем порциями: буфер фиксированного размера, одна запись на порцию
+     std::vector<double> buffer(CHUNK_POINTS * 3);
+     for (uint64_t i = manifest.begin; i < manifest.end; ) {
+         size_t count = std::min<uint64_t>(CHUNK_POINTS, manifest.end - i);
+         for (size_t j = 0; j < count; ++j, ++i) {
+             point3d p;
+             generator.rndAt(&p, i);
+             buffer[3 * j] = p.x;
+             buffer[3 * j + 1] = p.y;
+             buffer[3 * j + 2] = p.z;
+         }
+         data.write(reinterpret_cast<const char*>(buffer.data()), count * POINT_BYTES);
+         manifest.checksum = checksum(buffer.data(), count * POINT_BYTES, manifest.checksum);
+     }
+     data.close();
+     if (data.fail()) return false;
+
+     manifest.parts.push_back({manifest.begin, manifest.end,
+                               fs::path(dataName).filename().string()});
+     return manifest.save(prefix + ".manifest");
+ }
+
+ /**
+  * @brief Считает FNV-1a 64 по файлу за один проход, продолжая две суммы
+  * @param filename Имя файла
+  * @param shardHash Сумма шарда
+  * @param globalHash Сумма всего диапазона
+  * @return true, если файл прочитан полностью
+  */
+ static bool fileChecksum(const std::string& filename, uint64_t& shardHash, uint64_t& globalHash) {
+     std::ifstream file(filename, std::ios::binary);
+     if (!file.is_open()) return false;
+
+     std::vector<char> buffer(1 << 20);
+     while (file) {
+         file.read(buffer.data(), buffer.size());
+         shardHash = ConeShard::checksum(buffer.data(), file.gcount(), shardHash);
+         globalHash = ConeShard::checksum(buffer.data(), file.gcount(), globalHash);
+     }
+     return file.eof();
+ }
+
+ /**
+  * @brief Проверяет набор манифестов и данные, на которые они ссылаются
+  * @param manifests Манифесты шардов (сортируются по номеру первой точки)
+  * @param error Описание первой найденной ошибки
+  * @param checksum Контрольная сумма всего диапазона (если не nullptr)
+  * @return true, если шарды согласованы и данные целы
+  */
+ bool ConeShard::verify(std::vector<ShardManifest>& manifests, std::string& error,
+                        uint64_t* checksum) {
+     if (manifests.empty()) {
+         error = "нет манифестов";
+         return false;
+     }
+     std::sort(manifests.begin(), manifests.end(),
+               [](const ShardManifest& a, const ShardManifest& b) { return a.begin < b.begin; });
+
+     uint64_t expected = 0;
+     uint64_t globalHash = ConeShard::checksum(nullptr, 0);
+     for (const ShardManifest& m : manifests) {
+         std::string name = "шард " + std::to_string(m.shard) + "/" + std::to_string(m.shards);
+         if (!m.sameRun(manifests.front())) {
+             error = name + ": параметры конуса, зерно или total отличаются";
+             return false;
+         }
+         if (m.begin != expected) {
+             error = name + (m.begin < expected ? ": диапазон перекрывается с предыдущим"
+                                                : ": пропущены точки перед диапазоном")
+                     + " (ожидалось начало " + std::to_string(expected) + ")";
+             return false;
+         }
+
+         uint64_t hash = ConeShard::checksum(nullptr, 0);
+         uint64_t partStart = m.begin;
+         for (const ShardPart& part : m.parts) {
+             if (part.begin != partStart || part.end < part.begin) {
+                 error = name + ": части " + part.file + " идут не подряд";
+                 return false;
+             }
+             std::error_code ec;
+             uint64_t size = fs::file_size(part.file, ec);
+             if (ec || size != (part.end - part.begin) * POINT_BYTES) {
+                 error = name + ": размер " + part.file + " не соответствует диапазону";
+                 return false;
+             }
+             if (!fileChecksum(part.file, hash, globalHash)) {
+                 error = name + ": ошибка чтения " + part.file;
+                 return false;
+             }
+             partStart = part.end;
+         }
+         if (partStart != m.end) {
+             error = name + ": части не покрывают диапазон шарда";
+             return false;
+         }
+         if (hash != m.checksum) {
+             error = name + ": контрольная сумма не совпадает";
+             return false;
+         }
+         expected = m.end;
+     }
+     if (expected != manifests.front().total) {
+         error = "шарды покрывают " + std::to_string(expected) + " из " +
+                 std::to_string(manifests.front().total) + " точек";
+         return false;
+     }
+
+     if (checksum != nullptr) *checksum = globalHash;
+     return true;
+ }
+
+ /**
+  * @brief Копирует файл в конец открытого дескриптора средствами ядра
+  * @param from Имя исходного файла
+  * @param out Дескриптор выходного файла
+  * @return true, если файл скопирован полностью
+  */
+ static bool appendFile(const std::string& from, int out) {
+     int in = open(from.c_str(), O_RDONLY);
+     if (in < 0) return false;
+
+     bool ok = true;
+     for (;;) {
+         ssize_t n = copy_file_range(in, nullptr, out, nullptr, 1 << 30, 0);
+         if (n > 0) continue;
+         if (n == 0) break;
+
+         // Ядро или ФС не поддерживают copy_file_range - копируем через буфер
+         if (errno != EXDEV && errno != ENOSYS && errno != EOPNOTSUPP && errno != EINVAL) {
+             ok = false;
+             break;
+         }
+         std::vector<char> buffer(1 << 20);
+         ssize_t r;
+         while ((r = read(in, buffer.data(), buffer.size())) > 0) {
+             for (ssize_t done = 0; done < r; ) {
+                 ssize_t w = write(out, buffer.data() + done, r - done);
+                 if (w <= 0) {
+                     close(in);
+                     return false;
+                 }
+                 done += w;
+             }
+         }
+         ok = r == 0;
+         break;
+     }
+     close(in);
+     return ok;
+ }
+
+ /**
+  * @brief Проверяет, что выходной файл не совпадает ни с одним входным
+  * @param manifests Манифесты шардов
+  * @param output Имя выходного файла
+  * @param error Описание ошибки
+  * @return true, если output - не манифест и не часть из manifests
+  *
+  * Сравнение через fs::equivalent ловит и другие пути к тому же файлу
+  * (./part0.bin, жесткие ссылки). Несуществующий output ни с чем не совпадает.
+  */
+ static bool distinctOutput(const std::vector<ShardManifest>& manifests, const std::string& output,
+                            std::string& error) {
+     auto same = [&](const std::string& input) {
+         std::error_code ec;
+         return !input.empty() && fs::equivalent(output, input, ec);
+     };
+     for (const ShardManifest& m : manifests) {
+         bool clash = same(m.path);
+         for (const ShardPart& part : m.parts) clash = clash || same(part.file);
+         if (clash) {
+             error = output + ": совпадает с входным файлом";
+             return false;
+         }
+     }
+     return true;
+ }
+
+ /**
+  * @brief Склеивает данные шардов в один файл и пишет общий манифест
+  * @param manifests Манифесты шардов
+  * @param prefix Префикс имен выходных файлов
+  * @param error Описание ошибки
+  * @return true, если файлы записаны
+  */
+ bool ConeShard::merge(std::vector<ShardManifest>& manifests, const std::string& prefix,
+                       std::string& error) {
+     uint64_t hash = 0;
+     if (!verify(manifests, error, &hash)) return false;
+
+     std::string dataName = prefix + ".bin";
+     std::string manifestName = prefix + ".manifest";
+     if (!distinctOutput(manifests, dataName, error) ||
+         !distinctOutput(manifests, manifestName, error)) {
+         return false;
+     }
+
+     // Пишем во временный файл: прерванная склейка не портит старый prefix.bin
+     std::string tempName = dataName + ".tmp";
+     int out = open(tempName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+     if (out < 0) {
+         error = tempName + ": " + std::strerror(errno);
+         return false;
+     }
+     for (const ShardManifest& m : manifests) {
+         for (const ShardPart& part : m.parts) {
+             if (!appendFile(part.file, out)) {
+                 error = part.file + ": ошибка копирования";
+                 close(out);
+                 unlink(tempName.c_str());
+                 return false;
+             }
+         }
+     }
+     if (close(out) != 0 || rename(tempName.c_str(), dataName.c_str()) != 0) {
+         error = dataName + ": " + std::strerror(errno);
+         unlink(tempName.c_str());
+         return false;
+     }
+
+     ShardManifest merged = manifests.front();
+     merged.shard = 0;
+     merged.shards = 1;
+     merged.begin = 0;
+     merged.end = merged.total;
+     merged.checksum = hash;
+     merged.parts = {{0, merged.total, fs::path(dataName).filename().string()}};
+     if (!merged.save(manifestName)) {
+         error = manifestName + ": ошибка записи";
+         return false;
+     }
+     return true;
+ }
+
+ /**
+  * @brief Пишет общий манифест-индекс, ссылающийся на файлы шардов
+  * @param manifests Манифесты шардов
+  * @param filename Имя файла индекса
+  * @param error Описание ошибки
+  * @return true, если индекс записан
+  */
+ bool ConeShard::index(std::vector<ShardManifest>& manifests, const std::string& filename,
+                       std::string& error) {
+     uint64_t hash = 0;
+     if (!verify(manifests, error, &hash)) return false;
+     if (!distinctOutput(manifests, filename, error)) return false;
+
+     fs::path dir = fs::path(filename).parent_path();
+     if (dir.empty()) dir = ".";
+
+     ShardManifest indexed = manifests.front();
+     indexed.shard = 0;
+     indexed.shards = 1;
+     indexed.begin = 0;
+     indexed.end = indexed.total;
+     indexed.checksum = hash;
+     indexed.parts.clear();
+     for (const ShardManifest& m : manifests) {
+         for (const ShardPart& part : m.parts) {
+             indexed.parts.push_back({part.begin, part.end,
+                                      fs::proximate(part.file, dir).string()});
+         }
+     }
+     if (!indexed.save(filename)) {
+         error = filename + ": ошибка записи";
+         return false;
+     }
+     return true;
+ }
+
+ /**
+  * @brief Считает FNV-1a 64 по блоку байт
+  * @param data Указатель на данные
+  * @param size Размер в байтах
+  * @param hash Текущее значение суммы
+  * @return Новое значение суммы
+  */
+ uint64_t ConeShard::checksum(const void* data, size_t size, uint64_t hash) {
+     const unsigned char* bytes = static_cast<const unsigned char*>(data);
+     for (size_t i = 0; i < size; ++i) {
+         hash ^= bytes[i];
+         hash *= 0x100000001B3ULL;
+     }
+     return hash;
+ }
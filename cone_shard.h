@@ -0,0 +1,175 @@
+/**
+ * @file cone_shard.h
+ * @brief Заголовочный файл шардированной генерации точек (класс ConeShard)
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef CONE_SHARD_H
+#define CONE_SHARD_H
+
+#include "cone_gen.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Часть диапазона номеров точек и файл, в котором она лежит
+ */
+struct ShardPart {
+    uint64_t begin;   ///< Номер первой точки части
+    uint64_t end;     ///< Номер за последней точкой части
+    std::string file; ///< Файл с точками (относительно манифеста)
+};
+
+/**
+ * @brief Манифест шарда: параметры конуса, зерно, диапазон и контрольная сумма
+ *
+ * Манифест - текстовый файл из строк вида ключ=значение.
+ * Данные шарда хранятся отдельно, в двоичном файле без заголовка:
+ * на каждую точку три double (x, y, z) в порядке байт машины.
+ * Поэтому файлы соседних шардов можно склеивать без переписывания.
+ */
+struct ShardManifest {
+    double radius;                ///< Радиус конуса
+    double height;                ///< Высота конуса
+    point3d center;               ///< Центр основания конуса
+    point3d normal;               ///< Нормаль конуса
+    uint64_t seed;                ///< Зерно генератора
+    uint64_t total;               ///< Общее число точек во всех шардах
+    uint64_t shard;               ///< Номер шарда
+    uint64_t shards;              ///< Число шардов
+    uint64_t begin;               ///< Номер первой точки шарда
+    uint64_t end;                 ///< Номер за последней точкой шарда
+    uint64_t checksum;            ///< FNV-1a 64 по байтам данных шарда
+    std::vector<ShardPart> parts; ///< Файлы с данными по порядку номеров
+    std::string path;             ///< Файл, из которого прочитан манифест (заполняет load)
+
+    /**
+     * @brief Сохраняет манифест в файл
+     * @param filename Имя файла
+     * @return true, если файл записан
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @brief Загружает манифест из файла
+     * @param filename Имя файла
+     * @param error Описание ошибки, если загрузка не удалась
+     * @return true, если манифест прочитан полностью
+     */
+    bool load(const std::string& filename, std::string& error);
+
+    /**
+     * @brief Проверяет, что два манифеста описывают один и тот же запуск
+     * @param other Второй манифест
+     * @return true, если совпадают параметры конуса, зерно и общее число точек
+     */
+    bool sameRun(const ShardManifest& other) const;
+};
+
+/**
+ * @brief Класс для генерации шарда k из N общего диапазона номеров точек
+ *
+ * Общий диапазон [0, total) делится на N почти равных частей.
+ * Шард k генерирует точки с номерами [k*total/N, (k+1)*total/N) через
+ * ConeGen::rndAt, поэтому N независимых процессов с одинаковыми параметрами
+ * и зерном в сумме дают ровно тот же набор точек, что и один запуск.
+ * Манифест не хранит профили плотности, поэтому генератор с профилями
+ * (ConeGen::hasDensity) не принимается: write возвращает false.
+ */
+class ConeShard {
+private:
+    ConeGen generator; ///< Генератор с параметрами конуса и зерном
+    uint64_t total;    ///< Общее число точек
+    uint64_t shard;    ///< Номер шарда
+    uint64_t shards;   ///< Число шардов
+
+public:
+    /**
+     * @brief Конструктор класса ConeShard
+     * @param gen Генератор конуса (параметры и зерно)
+     * @param total Общее число точек во всех шардах
+     * @param shard Номер шарда (0..shards-1)
+     * @param shards Число шардов
+     */
+    ConeShard(const ConeGen& gen, uint64_t total, uint64_t shard, uint64_t shards);
+
+    /**
+     * @brief Возвращает номер первой точки шарда
+     * @return Номер первой точки
+     */
+    uint64_t begin() const { return total / shards * shard + rangeFix(shard); }
+
+    /**
+     * @brief Возвращает номер за последней точкой шарда
+     * @return Номер за последней точкой
+     */
+    uint64_t end() const { return total / shards * (shard + 1) + rangeFix(shard + 1); }
+
+    /**
+     * @brief Генерирует шард и записывает prefix.bin и prefix.manifest
+     * @param prefix Префикс имен файлов
+     * @return true, если оба файла записаны; false и для генератора с профилями плотности
+     */
+    bool write(const std::string& prefix) const;
+
+    /**
+     * @brief Проверяет набор манифестов и данные, на которые они ссылаются
+     * @param manifests Манифесты шардов
+     * @param error Описание первой найденной ошибки
+     * @param checksum Контрольная сумма всего диапазона (если не nullptr)
+     * @return true, если шарды одного запуска покрывают [0, total) без дыр
+     *         и перекрытий, а размеры и контрольные суммы файлов совпадают
+     */
+    static bool verify(std::vector<ShardManifest>& manifests, std::string& error,
+                       uint64_t* checksum = nullptr);
+
+    /**
+     * @brief Склеивает данные шардов в один файл и пишет общий манифест
+     * @param manifests Проверенные манифесты шардов
+     * @param prefix Префикс имен выходных файлов
+     * @param error Описание ошибки
+     * @return true, если файлы записаны
+     *
+     * Данные копируются средствами ядра (copy_file_range), без чтения
+     * в память процесса; на файловых системах с reflink копирования нет вовсе.
+     * Выходные файлы не могут совпадать с входными манифестами и частями;
+     * данные пишутся во временный файл и переименовываются после копирования.
+     */
+    static bool merge(std::vector<ShardManifest>& manifests, const std::string& prefix,
+                      std::string& error);
+
+    /**
+     * @brief Пишет общий манифест-индекс, ссылающийся на файлы шардов
+     * @param manifests Проверенные манифесты шардов
+     * @param filename Имя файла индекса
+     * @param error Описание ошибки
+     * @return true, если индекс записан
+     *
+     * Данные не копируются: индекс перечисляет части по порядку номеров.
+     * Индекс не может совпадать с входным манифестом или частью.
+     */
+    static bool index(std::vector<ShardManifest>& manifests, const std::string& filename,
+                      std::string& error);
+
+    /**
+     * @brief Считает FNV-1a 64 по блоку байт
+     * @param data Указатель на данные
+     * @param size Размер в байтах
+     * @param hash Текущее значение суммы (для продолжения подсчета)
+     * @return Новое значение суммы
+     */
+    static uint64_t checksum(const void* data, size_t size,
+                             uint64_t hash = 0xCBF29CE484222325ULL);
+
+private:
+    /**
+     * @brief Поправка границы шарда, распределяющая остаток total % shards
+     * @param k Номер границы
+     * @return Число дополнительных точек до границы k
+     */
+    uint64_t rangeFix(uint64_t k) const { return total % shards * k / shards; }
+};
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * @file density.cpp
+ * @brief Реализация методов класса DensityTable
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+ #include "density.h"
+ #include <algorithm>
+ #include <cmath>
+
+ /**
+  * @brief Конструктор пустой таблицы
+  * @param power Степень якобиана
+  */
+ DensityTable::DensityTable(int power) : power(power), interpolation(LINEAR) {}
+
+ /**
+  * @brief Строит таблицу обратной функции распределения по профилю
+  * @param density Профиль плотности p(x) на [0, 1]
+  * @param power Степень якобиана
+  * @param size Число узлов таблицы
+  * @param interpolation Вид интерполяции
+  * @return Таблица
+  *
+  * @details
+  * Функция распределения набирается на мелкой сетке (в 16 раз мельче
+  * таблицы, не меньше 4096 ячеек): в каждой ячейке профиль берется в
+  * середине, а якобиан интегрируется точно. Затем для каждого узла u_i
+  * ищется y = x^(power+1), при котором F = u_i.
+  */
+ std::shared_ptr<const DensityTable> DensityTable::fromFunction(
+     const std::function<double(double)>& density, int power,
+     size_t size, Interpolation interpolation) {
+     std::shared_ptr<DensityTable> table(new DensityTable(power));
+     table->interpolation = interpolation;
+     size = std::max<size_t>(size, 2);
+
+     // 1. Функция распределения на мелкой сетке (по y = x^(power+1))
+     const size_t cells = std::max<size_t>(4096, size * 16);
+     std::vector<double> y(cells + 1), cdf(cells + 1, 0.0);
+     for (size_t j = 0; j <= cells; ++j) y[j] = std::pow(double(j) / cells, power + 1);
+     for (size_t j = 0; j < cells; ++j) {
+         double p = density((j + 0.5) / cells);
+         cdf[j + 1] = cdf[j] + (p > 0 ? p : 0.0) * (y[j + 1] - y[j]);
+     }
+     double total = cdf[cells];
+     if (!(total > 0)) {
+         // Нулевой профиль - равномерная плотность
+         return fromFunction([](double) { return 1.0; }, power, size, interpolation);
+     }
+     for (double& c : cdf) c /= total;
+
+     // 2. Обратная функция в узлах: внутри ячейки F линейна по y
+     table->values.resize(size);
+     size_t j = 0;
+     for (size_t i = 0; i + 1 < size; ++i) {
+         double u = double(i) / (size - 1);
+         while (j + 1 < cells && cdf[j + 1] <= u) ++j;
+         double mass = cdf[j + 1] - cdf[j];
+         table->values[i] = mass > 0 ? y[j] + (u - cdf[j]) / mass * (y[j + 1] - y[j]) : y[j];
+     }
+     size_t last = cells;
+     while (last > 1 && cdf[last - 1] >= 1.0) --last; // конец носителя профиля
+     table->values[size - 1] = y[last];
+
+     // 3. Производные для монотонной кубической интерполяции (в единицах шага)
+     if (interpolation == CUBIC) {
+         std::vector<double>& v = table->values;
+         std::vector<double>& m = table->slopes;
+         m.assign(size, 0.0);
+         std::vector<double> d(size - 1);
+         for (size_t i = 0; i + 1 < size; ++i) d[i] = v[i + 1] - v[i];
+         m[0] = d[0];
+         m[size - 1] = d[size - 2];
+         for (size_t i = 1; i + 1 < size; ++i) {
+             m[i] = d[i - 1] * d[i] > 0 ? (d[i - 1] + d[i]) / 2 : 0.0;
+         }
+         for (size_t i = 0; i + 1 < size; ++i) {
+             if (d[i] == 0) {
+                 m[i] = m[i + 1] = 0;
+                 continue;
+             }
+             double a = m[i] / d[i], b = m[i + 1] / d[i];
+             double s = a * a + b * b;
+             if (s > 9) {
+                 double t = 3 / std::sqrt(s);
+                 m[i] = t * a * d[i];
+                 m[i + 1] = t * b * d[i];
+             }
+         }
+     }
+     return table;
+ }
+
+ /**
+  * @brief Строит таблицу псевдонимов по ступенчатому профилю
+  * @param weights Значения профиля на равных ступенях
+  * @param power Степень якобиана
+  * @return Таблица
+  *
+  * @details
+  * Масса ступени [a, b] равна w * (b^(power+1) - a^(power+1)).
+  * Метод Воуза раскладывает массы в N ячеек равной вероятности,
+  * в каждой - не более двух ступеней.
+  */
+ std::shared_ptr<const DensityTable> DensityTable::fromBins(const std::vector<double>& weights,
+                                                            int power) {
+     const size_t n = weights.size();
+     std::vector<double> mass(n);
+     double total = 0;
+     for (size_t i = 0; i < n; ++i) {
+         double a = std::pow(double(i) / n, power + 1);
+         double b = std::pow(double(i + 1) / n, power + 1);
+         mass[i] = (weights[i] > 0 ? weights[i] : 0.0) * (b - a);
+         total += mass[i];
+     }
+     if (!(total > 0)) return fromBins(std::vector<double>(1, 1.0), power);
+
+     std::shared_ptr<DensityTable> table(new DensityTable(power));
+     table->values.resize(n);
+     table->slopes.resize(n);
+     table->prob.assign(n, 1.0);
+     table->alias.resize(n);
+     for (size_t i = 0; i < n; ++i) {
+         table->values[i] = std::pow(double(i) / n, power + 1);
+         table->slopes[i] = std::pow(double(i + 1) / n, power + 1) - table->values[i];
+         table->alias[i] = static_cast<uint32_t>(i);
+         mass[i] *= n / total;
+     }
+
+     std::vector<uint32_t> small, large;
+     for (size_t i = 0; i < n; ++i) (mass[i] < 1 ? small : large).push_back(static_cast<uint32_t>(i));
+     while (!small.empty() && !large.empty()) {
+         uint32_t s = small.back(), l = large.back();
+         small.pop_back();
+         table->prob[s] = mass[s];
+         table->alias[s] = l;
+         mass[l] -= 1 - mass[s];
+         if (mass[l] < 1) {
+             large.pop_back();
+             small.push_back(l);
+         }
+     }
+     // Остатки из-за округления - ячейки без псевдонима
+     for (uint32_t i : small) table->prob[i] = 1.0;
+     for (uint32_t i : large) table->prob[i] = 1.0;
+     return table;
+ }
+
+ /**
+  * @brief Извлекает корень степени power+1
+  * @param y Значение x^(power+1)
+  * @return Координата x
+  */
+ double DensityTable::root(double y) const {
+     switch (power) {
+         case 0:  return y;
+         case 1:  return std::sqrt(std::max(0.0, y));
+         case 2:  return std::cbrt(y);
+         default: return std::pow(std::max(0.0, y), 1.0 / (power + 1));
+     }
+ }
+
+ /**
+  * @brief Возвращает координату x по равномерному числу u
+  * @param u Равномерное число из [0, 1)
+  * @return Координата из [0, 1]
+  */
+ double DensityTable::sample(double u) const {
+     if (!alias.empty()) {
+         // Одно число дает и ячейку, и выбор ступени, и положение внутри нее
+         const size_t n = alias.size();
+         double pos = u * n;
+         size_t i = std::min(n - 1, static_cast<size_t>(pos));
+         double f = pos - i;
+         size_t bin = i;
+         if (f < prob[i]) {
+             f /= prob[i];
+         } else {
+             f = (f - prob[i]) / (1 - prob[i]);
+             bin = alias[i];
+         }
+         return root(values[bin] + f * slopes[bin]);
+     }
+
+     const size_t n = values.size();
+     double pos = u * (n - 1);
+     size_t i = std::min(n - 2, static_cast<size_t>(pos));
+     double f = pos - i;
+     double y0 = values[i], y1 = values[i + 1];
+     if (interpolation == LINEAR) return root(y0 + f * (y1 - y0));
+
+     // Эрмитов сплайн на отрезке [i, i+1]
+     double f2 = f * f, f3 = f2 * f;
+     double y = (2 * f3 - 3 * f2 + 1) * y0 + (f3 - 2 * f2 + f) * slopes[i] +
+                (-2 * f3 + 3 * f2) * y1 + (f3 - f2) * slopes[i + 1];
+     return root(y);
+ }
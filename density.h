@@ -0,0 +1,98 @@
+/**
+ * @file density.h
+ * @brief Заголовочный файл класса DensityTable (неравномерная плотность точек)
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef DENSITY_H
+#define DENSITY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Предвычисленная таблица для выборки по плотности на [0, 1] за O(1)
+ *
+ * Выборка ведется с плотностью p(x) * x^power, где p - пользовательский
+ * профиль, а x^power - якобиан координаты конуса (power = 1 для радиуса
+ * в круге, power = 2 для расстояния от вершины вдоль оси).
+ *
+ * Два вида таблиц:
+ * - по функции: обратная функция распределения в узлах u_i = i/(size-1)
+ *   с линейной или кубической (монотонной Эрмитовой) интерполяцией;
+ * - по ступенчатому профилю: таблица псевдонимов (alias, метод Воуза),
+ *   внутри ступени координата находится точно.
+ *
+ * Таблица хранит не x, а x^(power+1): для равномерного профиля это прямая
+ * u, и интерполяция почти не вносит ошибки даже в малой таблице;
+ * x восстанавливается одним корнем, как в равномерном случае.
+ */
+class DensityTable {
+public:
+    /// Вид интерполяции обратной функции распределения
+    enum Interpolation {
+        LINEAR, ///< Кусочно-линейная
+        CUBIC   ///< Монотонная кубическая (Фрич-Карлсон)
+    };
+
+    /**
+     * @brief Строит таблицу обратной функции распределения по профилю
+     * @param density Профиль плотности p(x) на [0, 1], неотрицательный
+     * @param power Степень якобиана (0, 1 или 2)
+     * @param size Число узлов таблицы (не меньше 2)
+     * @param interpolation Вид интерполяции
+     * @return Таблица; для нулевого профиля - равномерная
+     */
+    static std::shared_ptr<const DensityTable> fromFunction(
+        const std::function<double(double)>& density, int power,
+        size_t size = 256, Interpolation interpolation = LINEAR);
+
+    /**
+     * @brief Строит таблицу псевдонимов по ступенчатому профилю
+     * @param weights Значения профиля на N равных ступенях [i/N, (i+1)/N]
+     * @param power Степень якобиана (0, 1 или 2)
+     * @return Таблица; для пустого или нулевого профиля - равномерная
+     */
+    static std::shared_ptr<const DensityTable> fromBins(const std::vector<double>& weights,
+                                                        int power);
+
+    /**
+     * @brief Возвращает координату x по равномерному числу u из [0, 1)
+     * @param u Равномерное число
+     * @return Координата из [0, 1]
+     */
+    double sample(double u) const;
+
+    /**
+     * @brief Возвращает число узлов (или ступеней) таблицы
+     * @return Размер таблицы
+     */
+    size_t size() const { return alias.empty() ? values.size() : alias.size(); }
+
+private:
+    int power;                   ///< Степень якобиана
+    Interpolation interpolation; ///< Вид интерполяции (для таблицы по функции)
+    std::vector<double> values;  ///< x^(power+1) в узлах, либо начала ступеней
+    std::vector<double> slopes;  ///< Производные в узлах (кубическая), либо ширины ступеней
+    std::vector<double> prob;    ///< Вероятность остаться в ступени (alias)
+    std::vector<uint32_t> alias; ///< Ступень-псевдоним (alias)
+
+    /**
+     * @brief Конструктор пустой таблицы (используют фабрики)
+     * @param power Степень якобиана
+     */
+    explicit DensityTable(int power);
+
+    /**
+     * @brief Извлекает корень степени power+1
+     * @param y Значение x^(power+1)
+     * @return Координата x
+     */
+    double root(double y) const;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file loader.cpp
+ * @brief Реализация многопоточной загрузки точек (класс PointLoader)
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+ #include "loader.h"
+ #include "parallel.h"
+ #include <charconv>
+ #include <cstring>
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+
+ /**
+  * @brief Часть файла, которую разбирает один поток
+  */
+ struct LoadChunk {
+     const char* begin;             ///< Начало первой строки части
+     const char* end;               ///< Конец части (начало строки следующей части)
+     std::vector<point3d> points;   ///< Разобранные точки
+     std::vector<LoadError> errors; ///< Ошибки с номерами строк внутри части (с 0)
+     uint64_t lines = 0;            ///< Число строк в части
+     uint64_t bad = 0;              ///< Число ошибочных строк в части
+ };
+
+ /**
+  * @brief Пропускает пробелы и табуляции
+  * @param p Текущая позиция
+  * @param end Конец строки
+  * @return Позиция первого другого символа
+  */
+ static const char* skipBlanks(const char* p, const char* end) {
+     while (p < end && (*p == ' ' || *p == '\t')) ++p;
+     return p;
+ }
+
+ /**
+  * @brief Разбирает строку "x y z"
+  * @param p Начало строки
+  * @param end Конец строки (без '\n')
+  * @param out Точка
+  * @return 1 - точка разобрана, 0 - пустая строка, -1 - ошибка
+  */
+ static int parseLine(const char* p, const char* end, point3d& out) {
+     if (end > p && end[-1] == '\r') --end; // файлы из Windows
+     p = skipBlanks(p, end);
+     if (p == end) return 0;
+
+     double v[3];
+     for (int k = 0; k < 3; ++k) {
+         p = skipBlanks(p, end);
+         if (p < end && *p == '+') ++p; // from_chars не принимает '+'
+         std::from_chars_result r = std::from_chars(p, end, v[k]);
+         if (r.ec != std::errc() || (r.ptr < end && *r.ptr != ' ' && *r.ptr != '\t')) return -1;
+         p = r.ptr;
+     }
+     if (skipBlanks(p, end) != end) return -1;
+
+     out = point3d(v[0], v[1], v[2]);
+     return 1;
+ }
+
+ /**
+  * @brief Разбирает часть файла
+  * @param chunk Часть
+  * @param maxErrors Сколько ошибок сохранять
+  */
+ static void parseChunk(LoadChunk& chunk, size_t maxErrors) {
+     // Оценка числа точек: в строке main.cpp обычно 25-35 байт
+     chunk.points.reserve((chunk.end - chunk.begin) / 24 + 1);
+     const char* p = chunk.begin;
+     while (p < chunk.end) {
+         const char* eol = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+         if (eol == nullptr) eol = chunk.end;
+
+         point3d point;
+         int status = parseLine(p, eol, point);
+         if (status > 0) {
+             chunk.points.push_back(point);
+         } else if (status < 0) {
+             if (chunk.errors.size() < maxErrors) {
+                 size_t len = std::min<size_t>(eol - p, 80);
+                 chunk.errors.push_back({chunk.lines, std::string(p, len)});
+             }
+             ++chunk.bad;
+         }
+         ++chunk.lines;
+         p = eol + 1;
+     }
+ }
+
+ /**
+  * @brief Загружает точки из файла
+  * @param filename Имя файла
+  * @param points Загруженные точки
+  * @param threads Число потоков
+  * @param maxErrors Сколько ошибок сохранять
+  * @return Результат загрузки
+  */
+ LoadResult PointLoader::load(const std::string& filename, std::vector<point3d>& points,
+                              unsigned threads, size_t maxErrors) {
+     LoadResult result = {false, 0, 0, {}};
+
+     int fd = open(filename.c_str(), O_RDONLY);
+     if (fd < 0) return result;
+     struct stat st;
+     if (fstat(fd, &st) != 0) {
+         close(fd);
+         return result;
+     }
+     const size_t size = static_cast<size_t>(st.st_size);
+     if (size == 0) {
+         close(fd);
+         result.ok = true;
+         return result;
+     }
+     void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+     close(fd);
+     if (map == MAP_FAILED) return result;
+     madvise(map, size, MADV_SEQUENTIAL);
+     const char* data = static_cast<const char*>(map);
+     const char* end = data + size;
+
+     // 1. Части с границами по началам строк
+     threads = threadCount(threads, size, 1 << 20);
+     std::vector<LoadChunk> chunks(threads);
+     for (unsigned t = 0; t < threads; ++t) {
+         const char* b = data + chunkBegin(size, t, threads);
+         if (b > data && b[-1] != '\n') {
+             const char* eol = static_cast<const char*>(std::memchr(b, '\n', end - b));
+             b = eol == nullptr ? end : eol + 1;
+         }
+         chunks[t].begin = t > 0 ? std::max(b, chunks[t - 1].begin) : data;
+     }
+     for (unsigned t = 0; t < threads; ++t) {
+         chunks[t].end = t + 1 < threads ? chunks[t + 1].begin : end;
+     }
+
+     // 2. Разбор частей
+     runThreads(threads, [&](unsigned t) { parseChunk(chunks[t], maxErrors); });
+     munmap(map, size);
+
+     // 3. Сборка: номера строк - в глобальные, точки - в общий массив
+     std::vector<size_t> offsets(threads + 1, points.size());
+     for (unsigned t = 0; t < threads; ++t) {
+         offsets[t + 1] = offsets[t] + chunks[t].points.size();
+         for (LoadError& e : chunks[t].errors) {
+             if (result.errors.size() < maxErrors) {
+                 result.errors.push_back({result.lines + e.line + 1, std::move(e.text)});
+             }
+         }
+         result.lines += chunks[t].lines;
+         result.badLines += chunks[t].bad;
+     }
+     points.resize(offsets[threads]);
+     runThreads(threads, [&](unsigned t) {
+         std::copy(chunks[t].points.begin(), chunks[t].points.end(), points.begin() + offsets[t]);
+         std::vector<point3d>().swap(chunks[t].points);
+     });
+
+     result.ok = true;
+     return result;
+ }
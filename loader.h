@@ -0,0 +1,60 @@
+/**
+ * @file loader.h
+ * @brief Заголовочный файл класса PointLoader (быстрая загрузка points.txt)
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef LOADER_H
+#define LOADER_H
+
+#include "point3d.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Описание строки файла, которую не удалось разобрать
+ */
+struct LoadError {
+    uint64_t line;    ///< Номер строки (с 1)
+    std::string text; ///< Содержимое строки (не длиннее 80 символов)
+};
+
+/**
+ * @brief Результат загрузки файла точек
+ */
+struct LoadResult {
+    bool ok;                       ///< Файл открыт и прочитан
+    uint64_t lines;                ///< Число строк в файле
+    uint64_t badLines;             ///< Число строк с ошибками
+    std::vector<LoadError> errors; ///< Первые ошибки по порядку строк
+};
+
+/**
+ * @brief Класс для многопоточной загрузки точек из текстового файла
+ *
+ * Формат - тот, что пишет main.cpp: по строке на точку, "x y z" через
+ * пробелы или табуляции. Пустые строки пропускаются.
+ *
+ * Файл отображается в память (mmap) и делится на части по числу потоков;
+ * границы частей сдвигаются к началу следующей строки. Каждый поток разбирает
+ * свою часть через std::from_chars прямо из отображенной памяти, без копий
+ * и без локали. Ошибочные строки не останавливают разбор: поток запоминает
+ * номер строки в своей части, номера переводятся в глобальные в конце.
+ */
+class PointLoader {
+public:
+    /**
+     * @brief Загружает точки из файла
+     * @param filename Имя файла
+     * @param points Загруженные точки (дописываются в конец)
+     * @param threads Число потоков (0 - по числу ядер)
+     * @param maxErrors Сколько ошибок сохранять в результате
+     * @return Результат загрузки
+     */
+    static LoadResult load(const std::string& filename, std::vector<point3d>& points,
+                           unsigned threads = 0, size_t maxErrors = 100);
+};
+
+#endif
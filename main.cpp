@@ -17,6 +17,9 @@
 #include <fstream>
 #include "point3d.h"
 #include "cone_gen.h"
+#include "morton.h"
+#include "raster.h"
+#include "loader.h"
 
 #include <mgl2/mgl.h>
 
@@ -201,6 +204,9 @@ int main() {
         std::cout << "4. Изменить параметры конуса" << std::endl;  
         std::cout << "5. Визуализация с MathGL" << std::endl;
         std::cout << "6. Вращать конус" << std::endl;
+        std::cout << "7. Сохранить в файл в Z-порядке (Мортон)" << std::endl;
+        std::cout << "8. Быстрая визуализация (встроенная отрисовка)" << std::endl;
+        std::cout << "9. Загрузить точки из points.txt и параметры из settings.dat" << std::endl;
         std::cout << "0. Выход" << std::endl;
         std::cout << "Выбор: ";
         std::cin >> choice;
@@ -320,6 +326,77 @@ int main() {
                 break;
             }
              
+            case 7: {
+                // СОРТИРОВКА ПО КОДУ МОРТОНА И СОХРАНЕНИЕ
+                MortonOrder order(generator);
+                order.sort(points, pointCount);
+                
+                std::ofstream file("points.txt");
+                if (!file.is_open()) {
+                    std::cout << "Ошибка открытия файла!" << std::endl;
+                    break;
+                }
+                for (int i = 0; i < pointCount; ++i) {
+                    file << points[i].x << " " << points[i].y << " " << points[i].z << "\n";
+                }
+                file.close();
+                generator.saveSet("settings.dat");
+                
+                if (order.writeBuckets("points_morton.bin", points, pointCount)) {
+                    std::cout << "Точки упорядочены по Z-кривой (индексы изменились)" << std::endl;
+                    std::cout << "Данные сохранены в points.txt, points_morton.bin и settings.dat" << std::endl;
+                } else {
+                    std::cout << "Ошибка записи points_morton.bin!" << std::endl;
+                }
+                break;
+            }
+             
+            case 8: {
+                // ВСТРОЕННАЯ ОТРИСОВКА ПЛОТНОСТИ ТОЧЕК
+                ConeRaster raster;
+                raster.render(points, pointCount, generator);
+                if (raster.writePNG("cone_raster.png")) {
+                    std::cout << "Визуализация сохранена в cone_raster.png" << std::endl;
+                    std::cout << "Максимум точек в пикселе: " << raster.maxHits() << std::endl;
+                } else {
+                    std::cout << "Ошибка записи cone_raster.png!" << std::endl;
+                }
+                break;
+            }
+             
+            case 9: {
+                // ЗАГРУЗКА ТОЧЕК И ПАРАМЕТРОВ
+                std::vector<point3d> loaded;
+                LoadResult result = PointLoader::load("points.txt", loaded, 0, 10);
+                if (!result.ok) {
+                    std::cout << "Ошибка открытия points.txt!" << std::endl;
+                    break;
+                }
+                for (const LoadError& e : result.errors) {
+                    std::cout << "Строка " << e.line << " пропущена: " << e.text << std::endl;
+                }
+                if (result.badLines > result.errors.size()) {
+                    std::cout << "... всего ошибочных строк: " << result.badLines << std::endl;
+                }
+                if (loaded.empty()) {
+                    std::cout << "В файле нет точек, массив не изменен" << std::endl;
+                    break;
+                }
+                
+                delete[] points;
+                pointCount = static_cast<int>(loaded.size());
+                points = new point3d[pointCount];
+                std::copy(loaded.begin(), loaded.end(), points);
+                
+                if (generator.loadSet("settings.dat")) {
+                    std::cout << "Параметры: " << generator.getParams() << std::endl;
+                } else {
+                    std::cout << "settings.dat не прочитан, параметры не изменены" << std::endl;
+                }
+                std::cout << "Загружено точек: " << pointCount << std::endl;
+                break;
+            }
+             
             case 0: {
                 std::cout << "Выход из программы." << std::endl;
                 break;
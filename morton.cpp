@@ -0,0 +1,309 @@
+/**
+ * @file morton.cpp
+ * @brief Реализация методов класса MortonOrder
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+ #include "morton.h"
+ #include "parallel.h"
+ #include <cstring>
+ #include <fstream>
+ #include <limits>
+ #include <memory>
+
+ /// Бит на цифру поразрядной сортировки
+ static const int RADIX_BITS = 11;
+
+ /// Число значений одной цифры
+ static const size_t RADIX = size_t(1) << RADIX_BITS;
+
+ /// Сигнатура двоичного файла с блоками
+ static const char MAGIC[8] = {'C', 'O', 'N', 'E', 'M', 'R', 'T', '1'};
+
+ /**
+  * @brief Пара ключ-номер для сортировки
+  */
+ struct MortonEntry {
+     uint64_t key;   ///< Код Мортона
+     uint64_t index; ///< Исходный номер точки
+ };
+
+ /**
+  * @brief Раздвигает 21 младший бит числа так, что между ними по два нуля
+  * @param v Число
+  * @return Число с битами в позициях 0, 3, 6, ...
+  */
+ static uint64_t spreadBits(uint64_t v) {
+     v &= 0x1FFFFF;
+     v = (v | v << 32) & 0x1F00000000FFFFULL;
+     v = (v | v << 16) & 0x1F0000FF0000FFULL;
+     v = (v | v << 8)  & 0x100F00F00F00F00FULL;
+     v = (v | v << 4)  & 0x10C30C30C30C30C3ULL;
+     v = (v | v << 2)  & 0x1249249249249249ULL;
+     return v;
+ }
+
+ /**
+  * @brief Конструктор по ограничивающему параллелепипеду конуса
+  * @param generator Генератор конуса
+  */
+ MortonOrder::MortonOrder(const ConeGen& generator) {
+     point3d bmin, bmax;
+     generator.getBounds(bmin, bmax);
+     *this = MortonOrder(bmin, bmax);
+ }
+
+ /**
+  * @brief Конструктор по произвольному параллелепипеду
+  * @param lo Минимальный угол
+  * @param hi Максимальный угол
+  */
+ MortonOrder::MortonOrder(const point3d& lo, const point3d& hi) : lo(lo), hi(hi) {
+     const double cells = double(1u << BITS);
+     point3d size = hi - lo;
+     scale = point3d(size.x > 0 ? cells / size.x : 0,
+                     size.y > 0 ? cells / size.y : 0,
+                     size.z > 0 ? cells / size.z : 0);
+ }
+
+ /**
+  * @brief Квантует координату в [0, 2^21)
+  * @param v Координата
+  * @param lo Нижняя граница по оси
+  * @param scale Множитель квантования по оси
+  * @return Номер ячейки по оси
+  */
+ uint32_t MortonOrder::quantize(double v, double lo, double scale) {
+     double q = (v - lo) * scale;
+     if (!(q > 0)) return 0;
+     const double top = double((1u << BITS) - 1);
+     return static_cast<uint32_t>(q < top ? q : top);
+ }
+
+ /**
+  * @brief Вычисляет код Мортона точки
+  * @param p Точка
+  * @return 63-битный ключ
+  */
+ uint64_t MortonOrder::key(const point3d& p) const {
+     return spreadBits(quantize(p.x, lo.x, scale.x)) |
+            spreadBits(quantize(p.y, lo.y, scale.y)) << 1 |
+            spreadBits(quantize(p.z, lo.z, scale.z)) << 2;
+ }
+
+ /**
+  * @brief Сортирует точки по коду Мортона
+  * @param points Массив точек
+  * @param count Количество точек
+  * @param threads Число потоков (0 - по числу ядер)
+  */
+ void MortonOrder::sort(point3d* points, size_t count, unsigned threads) const {
+     if (points == nullptr || count < 2) return;
+     threads = threadCount(threads, count, 1 << 16);
+
+     // Ключи и гистограммы цифр за один проход по точкам. Для одного потока
+     // гистограмма не зависит от порядка, и сразу считаются все проходы;
+     // для нескольких нужны счетчики по частям, а части после раскладки меняются.
+     const int passes = (3 * BITS + RADIX_BITS - 1) / RADIX_BITS;
+     const int fused = threads == 1 ? passes : 1;
+     // Буферы без обнуления: каждый элемент будет записан до чтения
+     std::unique_ptr<MortonEntry[]> src(new MortonEntry[count]);
+     std::unique_ptr<MortonEntry[]> dst(new MortonEntry[count]);
+     std::vector<size_t> hist(size_t(threads) * passes * RADIX, 0);
+     runThreads(threads, [&](unsigned t) {
+         size_t* h = &hist[size_t(t) * passes * RADIX];
+         for (size_t i = chunkBegin(count, t, threads), e = chunkBegin(count, t + 1, threads); i < e; ++i) {
+             uint64_t k = key(points[i]);
+             src[i] = {k, i};
+             for (int pass = 0; pass < fused; ++pass) {
+                 ++h[pass * RADIX + ((k >> (pass * RADIX_BITS)) & (RADIX - 1))];
+             }
+         }
+     });
+
+     for (int pass = 0; pass < passes; ++pass) {
+         const int shift = pass * RADIX_BITS;
+
+         if (pass >= fused) {
+             runThreads(threads, [&](unsigned t) {
+                 size_t* h = &hist[size_t(t) * passes * RADIX + pass * RADIX];
+                 for (size_t i = chunkBegin(count, t, threads), e = chunkBegin(count, t + 1, threads); i < e; ++i) {
+                     ++h[(src[i].key >> shift) & (RADIX - 1)];
+                 }
+             });
+         }
+         // Смещения: цифра - старший порядок, номер потока - младший (устойчивость)
+         size_t offset = 0;
+         bool trivial = false;
+         for (size_t d = 0; d < RADIX; ++d) {
+             size_t digitTotal = 0;
+             for (unsigned t = 0; t < threads; ++t) {
+                 size_t& c = hist[size_t(t) * passes * RADIX + pass * RADIX + d];
+                 size_t n = c;
+                 c = offset;
+                 offset += n;
+                 digitTotal += n;
+             }
+             if (digitTotal == count) trivial = true;
+         }
+         if (trivial) continue; // у всех ключей одна цифра - порядок не меняется
+
+         runThreads(threads, [&](unsigned t) {
+             size_t* h = &hist[size_t(t) * passes * RADIX + pass * RADIX];
+             for (size_t i = chunkBegin(count, t, threads), e = chunkBegin(count, t + 1, threads); i < e; ++i) {
+                 dst[h[(src[i].key >> shift) & (RADIX - 1)]++] = src[i];
+             }
+         });
+         src.swap(dst);
+     }
+
+     // Переставляем сами точки один раз
+     std::vector<point3d> sorted(count);
+     runThreads(threads, [&](unsigned t) {
+         for (size_t i = chunkBegin(count, t, threads), e = chunkBegin(count, t + 1, threads); i < e; ++i) {
+             sorted[i] = points[src[i].index];
+         }
+     });
+     std::copy(sorted.begin(), sorted.end(), points);
+ }
+
+ /**
+  * @brief Записывает отсортированные точки в двоичный файл с таблицей блоков
+  * @param filename Имя файла
+  * @param points Отсортированные точки
+  * @param count Количество точек
+  * @param levels Глубина октодерева блоков
+  * @return true, если файл записан
+  */
+ bool MortonOrder::writeBuckets(const std::string& filename, const point3d* points, size_t count,
+                                int levels) const {
+     if (levels < 1 || levels > 7 || (points == nullptr && count > 0)) return false;
+
+     const int shift = 3 * (BITS - levels);
+     const size_t buckets = size_t(1) << (3 * levels);
+     std::vector<uint64_t> offsets(buckets + 1, 0);
+     uint64_t previous = 0;
+     for (size_t i = 0; i < count; ++i) {
+         uint64_t b = key(points[i]) >> shift;
+         if (b < previous) return false; // точки не отсортированы sort()
+         previous = b;
+         ++offsets[b + 1];
+     }
+     for (size_t b = 0; b < buckets; ++b) offsets[b + 1] += offsets[b];
+
+     std::ofstream file(filename, std::ios::binary);
+     if (!file.is_open()) return false;
+
+     uint32_t header[2] = {static_cast<uint32_t>(levels), 0};
+     double box[6] = {lo.x, lo.y, lo.z, hi.x, hi.y, hi.z};
+     uint64_t total = count;
+     file.write(MAGIC, sizeof(MAGIC));
+     file.write(reinterpret_cast<const char*>(header), sizeof(header));
+     file.write(reinterpret_cast<const char*>(box), sizeof(box));
+     file.write(reinterpret_cast<const char*>(&total), sizeof(total));
+     file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+
+     // point3d - три double подряд, но пишем явно, чтобы не зависеть от раскладки
+     std::vector<double> buffer;
+     buffer.reserve(3 * 65536);
+     for (size_t i = 0; i < count; ++i) {
+         buffer.push_back(points[i].x);
+         buffer.push_back(points[i].y);
+         buffer.push_back(points[i].z);
+         if (buffer.size() == buffer.capacity() || i + 1 == count) {
+             file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(double));
+             buffer.clear();
+         }
+     }
+     return file.good();
+ }
+
+ /**
+  * @brief Читает из файла с блоками точки, попавшие в параллелепипед
+  * @param filename Имя файла
+  * @param qlo Минимальный угол области
+  * @param qhi Максимальный угол области
+  * @param out Найденные точки
+  * @param scanned Число прочитанных с диска точек
+  * @return true, если файл прочитан
+  */
+ bool MortonOrder::readRegion(const std::string& filename, const point3d& qlo, const point3d& qhi,
+                              std::vector<point3d>& out, size_t* scanned) {
+     std::ifstream file(filename, std::ios::binary);
+     if (!file.is_open()) return false;
+
+     char magic[8];
+     uint32_t header[2];
+     double box[6];
+     uint64_t total = 0;
+     file.read(magic, sizeof(magic));
+     file.read(reinterpret_cast<char*>(header), sizeof(header));
+     file.read(reinterpret_cast<char*>(box), sizeof(box));
+     file.read(reinterpret_cast<char*>(&total), sizeof(total));
+     if (!file || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || header[0] < 1 || header[0] > 7) {
+         return false;
+     }
+
+     const int levels = static_cast<int>(header[0]);
+     const size_t buckets = size_t(1) << (3 * levels);
+     const uint32_t side = 1u << levels;
+     std::vector<uint64_t> offsets(buckets + 1);
+     file.read(reinterpret_cast<char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+     if (!file || offsets[buckets] != total) return false;
+     const std::streamoff payload = file.tellg();
+
+     const double qmin[3] = {qlo.x, qlo.y, qlo.z};
+     const double qmax[3] = {qhi.x, qhi.y, qhi.z};
+     const double inf = std::numeric_limits<double>::infinity();
+
+     // Пересекает ли ячейка блока b область запроса
+     auto intersects = [&](size_t b) {
+         uint32_t cell[3] = {0, 0, 0};
+         for (int bit = 0; bit < levels; ++bit) {
+             for (int axis = 0; axis < 3; ++axis) {
+                 cell[axis] |= ((b >> (3 * bit + axis)) & 1u) << bit;
+             }
+         }
+         for (int axis = 0; axis < 3; ++axis) {
+             double size = (box[3 + axis] - box[axis]) / side;
+             double eps = size * 1e-9;
+             // Крайние ячейки продолжаются до бесконечности: туда прижаты точки вне box
+             double cmin = cell[axis] == 0 ? -inf : box[axis] + cell[axis] * size - eps;
+             double cmax = cell[axis] == side - 1 ? inf : box[axis] + (cell[axis] + 1) * size + eps;
+             if (cmax < qmin[axis] || cmin > qmax[axis]) return false;
+         }
+         return true;
+     };
+
+     size_t read = 0;
+     std::vector<double> buffer;
+     for (size_t b = 0; b < buckets; ) {
+         if (offsets[b] == offsets[b + 1] || !intersects(b)) {
+             ++b;
+             continue;
+         }
+         // Объединяем подряд идущие подходящие блоки в одно чтение
+         size_t last = b + 1;
+         while (last < buckets && (offsets[last] == offsets[last + 1] || intersects(last))) ++last;
+
+         uint64_t first = offsets[b], end = offsets[last];
+         buffer.resize(3 * (end - first));
+         file.seekg(payload + static_cast<std::streamoff>(first * 3 * sizeof(double)));
+         file.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(double));
+         if (!file) return false;
+         read += end - first;
+
+         for (size_t i = 0; i < buffer.size(); i += 3) {
+             point3d p(buffer[i], buffer[i + 1], buffer[i + 2]);
+             if (p.x >= qlo.x && p.x <= qhi.x && p.y >= qlo.y && p.y <= qhi.y &&
+                 p.z >= qlo.z && p.z <= qhi.z) {
+                 out.push_back(p);
+             }
+         }
+         b = last;
+     }
+
+     if (scanned != nullptr) *scanned = read;
+     return true;
+ }
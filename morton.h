@@ -0,0 +1,112 @@
+/**
+ * @file morton.h
+ * @brief Заголовочный файл класса MortonOrder (Z-порядок точек)
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef MORTON_H
+#define MORTON_H
+
+#include "cone_gen.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Класс для упорядочивания точек по 3D коду Мортона (Z-порядок)
+ *
+ * Координаты точки квантуются в 21 бит по каждой оси внутри
+ * ограничивающего параллелепипеда конуса, биты чередуются в 63-битный ключ.
+ * Точки, близкие по ключу, близки в пространстве, поэтому проходы по
+ * соседям, вокселизация и отрисовка читают память последовательно.
+ *
+ * Двоичный файл с блоками (writeBuckets) содержит таблицу смещений:
+ * блок - ячейка октодерева глубины levels, т.е. старшие 3*levels бит ключа.
+ * Область пространства читается только из пересекающих ее блоков.
+ */
+class MortonOrder {
+private:
+    point3d lo;    ///< Минимальный угол ограничивающего параллелепипеда
+    point3d hi;    ///< Максимальный угол ограничивающего параллелепипеда
+    point3d scale; ///< Множители квантования по осям (2^21 / размер)
+
+public:
+    /// Число бит на ось в ключе
+    static const int BITS = 21;
+
+    /**
+     * @brief Конструктор по ограничивающему параллелепипеду конуса
+     * @param generator Генератор конуса
+     */
+    explicit MortonOrder(const ConeGen& generator);
+
+    /**
+     * @brief Конструктор по произвольному параллелепипеду
+     * @param lo Минимальный угол
+     * @param hi Максимальный угол
+     */
+    MortonOrder(const point3d& lo, const point3d& hi);
+
+    /**
+     * @brief Вычисляет код Мортона точки
+     * @param p Точка (вне параллелепипеда прижимается к его границе)
+     * @return 63-битный ключ
+     */
+    uint64_t key(const point3d& p) const;
+
+    /**
+     * @brief Сортирует точки по коду Мортона
+     * @param points Массив точек
+     * @param count Количество точек
+     * @param threads Число потоков (0 - по числу ядер)
+     *
+     * Поразрядная сортировка (LSD) пар ключ-номер по 11 бит за проход:
+     * каждый поток строит гистограмму своей части, смещения считаются
+     * по всем потокам, затем каждый поток раскладывает свою часть.
+     * Проходы, в которых у всех ключей одна и та же цифра, пропускаются.
+     */
+    void sort(point3d* points, size_t count, unsigned threads = 0) const;
+
+    /**
+     * @brief Записывает отсортированные точки в двоичный файл с таблицей блоков
+     * @param filename Имя файла
+     * @param points Точки, отсортированные sort()
+     * @param count Количество точек
+     * @param levels Глубина октодерева блоков (1..7, блоков 8^levels)
+     * @return true, если файл записан
+     *
+     * Формат: "CONEMRT1", uint32 levels, uint32 0, double lo[3], double hi[3],
+     * uint64 count, uint64 offsets[8^levels + 1] (номера точек), затем точки
+     * по три double (x, y, z).
+     */
+    bool writeBuckets(const std::string& filename, const point3d* points, size_t count,
+                      int levels = 4) const;
+
+    /**
+     * @brief Читает из файла с блоками точки, попавшие в параллелепипед
+     * @param filename Имя файла, записанного writeBuckets()
+     * @param qlo Минимальный угол области
+     * @param qhi Максимальный угол области
+     * @param out Найденные точки (дописываются в конец)
+     * @param scanned Число прочитанных с диска точек (если не nullptr)
+     * @return true, если файл прочитан
+     *
+     * Читаются только блоки, чьи ячейки пересекают область; соседние
+     * блоки объединяются в одно чтение.
+     */
+    static bool readRegion(const std::string& filename, const point3d& qlo, const point3d& qhi,
+                           std::vector<point3d>& out, size_t* scanned = nullptr);
+
+private:
+    /**
+     * @brief Квантует координату в [0, 2^21)
+     * @param v Координата
+     * @param lo Нижняя граница по оси
+     * @param scale Множитель квантования по оси
+     * @return Номер ячейки по оси
+     */
+    static uint32_t quantize(double v, double lo, double scale);
+};
+
+#endif
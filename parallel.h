@@ -0,0 +1,55 @@
+/**
+ * @file parallel.h
+ * @brief Вспомогательные функции для запуска работы в нескольких потоках
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Выбирает число потоков для задачи
+ * @param requested Запрошенное число потоков (0 - по числу ядер)
+ * @param work Объем работы (например, число точек)
+ * @param minPerThread Минимальный объем работы на поток
+ * @return Число потоков от 1 до requested
+ */
+inline unsigned threadCount(unsigned requested, size_t work, size_t minPerThread) {
+    if (requested == 0) requested = std::max(1u, std::thread::hardware_concurrency());
+    size_t useful = work / std::max<size_t>(1, minPerThread) + 1;
+    return static_cast<unsigned>(std::min<size_t>(requested, useful));
+}
+
+/**
+ * @brief Выполняет fn(t) для t = 0..threads-1, каждый вызов в своем потоке
+ * @param threads Число потоков
+ * @param fn Функция от номера потока
+ *
+ * Вызов с номером 0 выполняется в текущем потоке.
+ */
+template <typename F>
+void runThreads(unsigned threads, F fn) {
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(fn, t);
+    fn(0u);
+    for (std::thread& th : pool) th.join();
+}
+
+/**
+ * @brief Возвращает начало части t из threads диапазона [0, n)
+ * @param n Размер диапазона
+ * @param t Номер части
+ * @param threads Число частей
+ * @return Номер первого элемента части
+ */
+inline size_t chunkBegin(size_t n, unsigned t, unsigned threads) {
+    return n / threads * t + n % threads * t / threads;
+}
+
+#endif
@@ -0,0 +1,314 @@
+/**
+ * @file raster.cpp
+ * @brief Реализация методов класса ConeRaster
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+ #include "raster.h"
+ #include "parallel.h"
+ #include <algorithm>
+ #include <array>
+ #include <cmath>
+ #include <fstream>
+
+ /// Поворот камеры вокруг оси Z (градусы), как в gr.Rotate(60, 40)
+ static const double CAMERA_TET_Z = 40.0;
+
+ /// Наклон камеры вокруг оси X (градусы), как в gr.Rotate(60, 40)
+ static const double CAMERA_TET_X = 60.0;
+
+ /**
+  * @brief Конструктор класса ConeRaster
+  * @param width Ширина изображения
+  * @param height Высота изображения
+  */
+ ConeRaster::ConeRaster(int width, int height)
+     : width(width), height(height), hits(size_t(width) * height, 0),
+       rgb(size_t(width) * height * 3, 255), range(1), scale(1) {}
+
+ /**
+  * @brief Настраивает камеру по параметрам конуса
+  * @param generator Генератор конуса
+  *
+  * Куб обзора и масштаб - как в visualizePoints: центр основания,
+  * полуширина 1.5 * max(radius, height); куб целиком помещается в кадр.
+  */
+ void ConeRaster::setupCamera(const ConeGen& generator) {
+     origin = generator.getCenter();
+     range = std::max(generator.getRadius(), generator.getHeight()) * 1.5;
+     if (!(range > 0)) range = 1;
+
+     const double z = CAMERA_TET_Z * M_PI / 180, x = CAMERA_TET_X * M_PI / 180;
+     double halfWidth = std::cos(z) + std::sin(z);
+     double halfHeight = std::sin(x) + (std::sin(z) + std::cos(z)) * std::cos(x);
+     scale = 0.9 * std::min(width / (2 * halfWidth), height / (2 * halfHeight));
+ }
+
+ /**
+  * @brief Проецирует точку на экран
+  * @param p Точка в мировых координатах
+  * @param sx Столбец пикселя
+  * @param sy Строка пикселя
+  */
+ void ConeRaster::project(const point3d& p, double& sx, double& sy) const {
+     static const double cz = std::cos(CAMERA_TET_Z * M_PI / 180);
+     static const double sz = std::sin(CAMERA_TET_Z * M_PI / 180);
+     static const double cx = std::cos(CAMERA_TET_X * M_PI / 180);
+     static const double sx60 = std::sin(CAMERA_TET_X * M_PI / 180);
+
+     point3d q = (p - origin) / range;
+     double right = q.x * cz + q.y * sz;
+     double depth = q.y * cz - q.x * sz;
+     double up = q.z * sx60 + depth * cx;
+     sx = width * 0.5 + right * scale;
+     sy = height * 0.5 - up * scale;
+ }
+
+ /**
+  * @brief Отрисовывает точки и контур конуса
+  * @param points Массив точек
+  * @param count Количество точек
+  * @param generator Генератор конуса
+  * @param threads Число потоков
+  */
+ void ConeRaster::render(const point3d* points, size_t count, const ConeGen& generator,
+                         unsigned threads) {
+     setupCamera(generator);
+     threads = threadCount(threads, count, 1 << 16);
+     const size_t pixels = size_t(width) * height;
+
+     // 1. Накопление: поток 0 пишет прямо в hits, остальные - в свои буферы
+     std::fill(hits.begin(), hits.end(), 0);
+     std::vector<std::vector<uint32_t>> local(threads - 1, std::vector<uint32_t>(pixels, 0));
+     runThreads(threads, [&](unsigned t) {
+         uint32_t* acc = t == 0 ? hits.data() : local[t - 1].data();
+         for (size_t i = chunkBegin(count, t, threads), e = chunkBegin(count, t + 1, threads); i < e; ++i) {
+             double sx, sy;
+             project(points[i], sx, sy);
+             if (sx >= 0 && sy >= 0 && sx < width && sy < height) {
+                 ++acc[size_t(sy) * width + size_t(sx)];
+             }
+         }
+     });
+
+     // 2. Слияние буферов по полосам строк
+     unsigned mergeThreads = threadCount(threads, height, 16);
+     if (!local.empty()) {
+         runThreads(mergeThreads, [&](unsigned t) {
+             size_t begin = chunkBegin(height, t, mergeThreads) * width;
+             size_t end = chunkBegin(height, t + 1, mergeThreads) * width;
+             for (const std::vector<uint32_t>& buf : local) {
+                 for (size_t i = begin; i < end; ++i) hits[i] += buf[i];
+             }
+         });
+     }
+
+     // 3. Цвет по логарифму плотности; пустые пиксели - белые
+     static const double stops[5][3] = {
+         {252, 255, 164}, {249, 142, 9}, {188, 55, 84}, {87, 16, 110}, {0, 0, 4}
+     };
+     const double norm = 1.0 / std::log1p(double(std::max<uint32_t>(1, maxHits())));
+     runThreads(mergeThreads, [&](unsigned t) {
+         size_t end = chunkBegin(height, t + 1, mergeThreads) * width;
+         for (size_t i = chunkBegin(height, t, mergeThreads) * width; i < end; ++i) {
+             uint8_t* px = &rgb[3 * i];
+             if (hits[i] == 0) {
+                 px[0] = px[1] = px[2] = 255;
+                 continue;
+             }
+             double v = std::log1p(double(hits[i])) * norm * 4;
+             int k = std::min(3, int(v));
+             double f = v - k;
+             for (int c = 0; c < 3; ++c) {
+                 px[c] = static_cast<uint8_t>(stops[k][c] + (stops[k + 1][c] - stops[k][c]) * f);
+             }
+         }
+     });
+
+     // 4. Контур конуса и оси - те же линии, что рисует visualizePoints
+     double radius = generator.getRadius();
+     point3d center = generator.getCenter();
+     point3d apex = generator.getApex();
+     point3d z_axis = generator.getNormal().normalize();
+     point3d arbitrary(1, 0, 0);
+     if (std::abs(z_axis.dot(arbitrary)) > 0.9) {
+         arbitrary = point3d(0, 1, 0);
+     }
+     point3d x_axis = z_axis.cross(arbitrary).normalize();
+     point3d y_axis = z_axis.cross(x_axis).normalize();
+     auto onBase = [&](double angle) {
+         return center + x_axis * (radius * std::cos(angle)) + y_axis * (radius * std::sin(angle));
+     };
+
+     const int circlePoints = 50;
+     for (int i = 0; i + 1 < circlePoints; ++i) {
+         drawLine(onBase(2 * M_PI * i / (circlePoints - 1)),
+                  onBase(2 * M_PI * (i + 1) / (circlePoints - 1)), 0, 0, 255);
+     }
+     for (int i = 0; i < 4; ++i) {
+         drawLine(onBase(i * M_PI / 2), apex, 0, 0, 255);
+     }
+     drawLine(center, center + point3d(range * 0.8, 0, 0), 255, 0, 0);
+     drawLine(center, center + point3d(0, range * 0.8, 0), 0, 160, 0);
+     drawLine(center, center + point3d(0, 0, range * 0.8), 0, 0, 255);
+ }
+
+ /**
+  * @brief Рисует отрезок между двумя точками (алгоритм Брезенхема)
+  * @param a Начало
+  * @param b Конец
+  * @param r,g,b8 Цвет
+  */
+ void ConeRaster::drawLine(const point3d& a, const point3d& b, uint8_t r, uint8_t g, uint8_t b8) {
+     double ax, ay, bx, by;
+     project(a, ax, ay);
+     project(b, bx, by);
+     int x0 = int(std::lround(ax)), y0 = int(std::lround(ay));
+     int x1 = int(std::lround(bx)), y1 = int(std::lround(by));
+
+     int dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+     int dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+     int err = dx + dy;
+     for (;;) {
+         if (x0 >= 0 && y0 >= 0 && x0 < width && y0 < height) {
+             uint8_t* px = &rgb[3 * (size_t(y0) * width + x0)];
+             px[0] = r;
+             px[1] = g;
+             px[2] = b8;
+         }
+         if (x0 == x1 && y0 == y1) break;
+         int e2 = 2 * err;
+         if (e2 >= dy) { err += dy; x0 += sx; }
+         if (e2 <= dx) { err += dx; y0 += sy; }
+     }
+ }
+
+ /**
+  * @brief Возвращает максимальное число точек в одном пикселе
+  * @return Максимум плотности
+  */
+ uint32_t ConeRaster::maxHits() const {
+     return hits.empty() ? 0 : *std::max_element(hits.begin(), hits.end());
+ }
+
+ /**
+  * @brief Сохраняет изображение в формате PPM (P6)
+  * @param filename Имя файла
+  * @return true, если файл записан
+  */
+ bool ConeRaster::writePPM(const std::string& filename) const {
+     std::ofstream file(filename, std::ios::binary);
+     if (!file.is_open()) return false;
+     file << "P6\n" << width << " " << height << "\n255\n";
+     file.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+     return file.good();
+ }
+
+ /**
+  * @brief Считает CRC-32 (полином 0xEDB88320), продолжая текущее значение
+  * @param crc Текущее значение (начальное - 0)
+  * @param data Данные
+  * @param size Размер в байтах
+  * @return Новое значение
+  */
+ static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) {
+     // Инициализация локальной static-переменной потокобезопасна
+     static const std::array<uint32_t, 256> table = [] {
+         std::array<uint32_t, 256> t;
+         for (uint32_t n = 0; n < 256; ++n) {
+             uint32_t c = n;
+             for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+             t[n] = c;
+         }
+         return t;
+     }();
+     crc = ~crc;
+     for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+     return ~crc;
+ }
+
+ /**
+  * @brief Дописывает 32-битное число в порядке big-endian
+  * @param out Буфер
+  * @param v Число
+  */
+ static void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+     out.push_back(uint8_t(v >> 24));
+     out.push_back(uint8_t(v >> 16));
+     out.push_back(uint8_t(v >> 8));
+     out.push_back(uint8_t(v));
+ }
+
+ /**
+  * @brief Записывает блок PNG (длина, тип, данные, CRC)
+  * @param file Выходной файл
+  * @param type Тип блока из 4 символов
+  * @param data Данные блока
+  */
+ static void writeChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+     std::vector<uint8_t> head;
+     putBE32(head, static_cast<uint32_t>(data.size()));
+     head.insert(head.end(), type, type + 4);
+     uint32_t crc = crc32(0, head.data() + 4, 4);
+     crc = crc32(crc, data.data(), data.size());
+     std::vector<uint8_t> tail;
+     putBE32(tail, crc);
+     file.write(reinterpret_cast<const char*>(head.data()), head.size());
+     file.write(reinterpret_cast<const char*>(data.data()), data.size());
+     file.write(reinterpret_cast<const char*>(tail.data()), tail.size());
+ }
+
+ /**
+  * @brief Сохраняет изображение в формате PNG
+  * @param filename Имя файла
+  * @return true, если файл записан
+  */
+ bool ConeRaster::writePNG(const std::string& filename) const {
+     std::ofstream file(filename, std::ios::binary);
+     if (!file.is_open()) return false;
+
+     static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+     file.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+     // IHDR: размеры, 8 бит на канал, RGB, без чересстрочности
+     std::vector<uint8_t> ihdr;
+     putBE32(ihdr, width);
+     putBE32(ihdr, height);
+     ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});
+     writeChunk(file, "IHDR", ihdr);
+
+     // Сырые строки с фильтром 0 перед каждой
+     const size_t stride = size_t(width) * 3;
+     std::vector<uint8_t> raw;
+     raw.reserve((stride + 1) * height);
+     for (int y = 0; y < height; ++y) {
+         raw.push_back(0);
+         raw.insert(raw.end(), rgb.begin() + y * stride, rgb.begin() + (y + 1) * stride);
+     }
+
+     // IDAT: zlib-заголовок, stored-блоки deflate по 65535 байт, Adler-32
+     std::vector<uint8_t> idat = {0x78, 0x01};
+     idat.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+     for (size_t pos = 0; pos < raw.size() || raw.empty(); ) {
+         size_t len = std::min<size_t>(65535, raw.size() - pos);
+         bool last = pos + len == raw.size();
+         idat.push_back(last ? 1 : 0);
+         idat.push_back(uint8_t(len));
+         idat.push_back(uint8_t(len >> 8));
+         idat.push_back(uint8_t(~len));
+         idat.push_back(uint8_t(~len >> 8));
+         idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+         pos += len;
+         if (last) break;
+     }
+     uint32_t a = 1, b = 0;
+     for (uint8_t byte : raw) {
+         a = (a + byte) % 65521;
+         b = (b + a) % 65521;
+     }
+     putBE32(idat, (b << 16) | a);
+     writeChunk(file, "IDAT", idat);
+     writeChunk(file, "IEND", {});
+     return file.good();
+ }
@@ -0,0 +1,102 @@
+/**
+ * @file raster.h
+ * @brief Заголовочный файл класса ConeRaster (встроенная отрисовка облака точек)
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef RASTER_H
+#define RASTER_H
+
+#include "cone_gen.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Класс для быстрой отрисовки облака точек без внешних библиотек
+ *
+ * Точки проецируются той же камерой, что и в visualizePoints
+ * (куб center +- 1.5 * max(radius, height), gr.Rotate(60, 40),
+ * ортографическая проекция), и накапливаются как плотность: сколько
+ * точек попало в пиксель. Каждый поток копит свою часть точек в своем
+ * буфере, затем буферы складываются по строкам. Цвет пикселя - по
+ * логарифму плотности. Поверх рисуется контур конуса (круг основания,
+ * ребра к вершине) и оси координат, как в MathGL-версии.
+ */
+class ConeRaster {
+private:
+    int width;                  ///< Ширина изображения
+    int height;                 ///< Высота изображения
+    std::vector<uint32_t> hits; ///< Число точек в каждом пикселе
+    std::vector<uint8_t> rgb;   ///< Итоговое изображение, 3 байта на пиксель
+    point3d origin;             ///< Центр куба обзора
+    double range;               ///< Половина стороны куба обзора
+    double scale;               ///< Пикселей на единицу нормированного куба
+
+public:
+    /**
+     * @brief Конструктор класса ConeRaster
+     * @param width Ширина изображения (по умолчанию как в visualizePoints)
+     * @param height Высота изображения
+     */
+    ConeRaster(int width = 1000, int height = 800);
+
+    /**
+     * @brief Отрисовывает точки и контур конуса
+     * @param points Массив точек
+     * @param count Количество точек
+     * @param generator Генератор конуса (камера и контур)
+     * @param threads Число потоков (0 - по числу ядер)
+     */
+    void render(const point3d* points, size_t count, const ConeGen& generator,
+                unsigned threads = 0);
+
+    /**
+     * @brief Сохраняет изображение в формате PPM (P6)
+     * @param filename Имя файла
+     * @return true, если файл записан
+     */
+    bool writePPM(const std::string& filename) const;
+
+    /**
+     * @brief Сохраняет изображение в формате PNG
+     * @param filename Имя файла
+     * @return true, если файл записан
+     *
+     * Поток zlib состоит из несжатых (stored) блоков deflate:
+     * файл больше, чем у libpng, зато без внешних зависимостей.
+     */
+    bool writePNG(const std::string& filename) const;
+
+    /**
+     * @brief Возвращает максимальное число точек в одном пикселе
+     * @return Максимум плотности
+     */
+    uint32_t maxHits() const;
+
+private:
+    /**
+     * @brief Настраивает камеру по параметрам конуса
+     * @param generator Генератор конуса
+     */
+    void setupCamera(const ConeGen& generator);
+
+    /**
+     * @brief Проецирует точку на экран
+     * @param p Точка в мировых координатах
+     * @param sx Столбец пикселя
+     * @param sy Строка пикселя
+     */
+    void project(const point3d& p, double& sx, double& sy) const;
+
+    /**
+     * @brief Рисует отрезок между двумя точками (алгоритм Брезенхема)
+     * @param a Начало в мировых координатах
+     * @param b Конец в мировых координатах
+     * @param r,g,b8 Цвет
+     */
+    void drawLine(const point3d& a, const point3d& b, uint8_t r, uint8_t g, uint8_t b8);
+};
+
+#endif
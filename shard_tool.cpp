@@ -0,0 +1,150 @@
+/**
+ * @file shard_tool.cpp
+ * @brief Утилита шардированной генерации: gen, verify, merge, index
+ *
+ * @details
+ * Большой запуск делится на N независимых процессов с одинаковыми
+ * параметрами конуса и зерном:
+ * @code
+ * for k in 0 1 2 3; do ./shard_tool gen 100000000 $k 4 42 part$k & done; wait
+ * ./shard_tool verify part*.manifest
+ * ./shard_tool merge all part*.manifest        # all.bin + all.manifest
+ * ./shard_tool index all.manifest part*.manifest  # без копирования данных
+ * @endcode
+ * Результат совпадает байт в байт с запуском "gen 100000000 0 1 42 all".
+ *
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "cone_shard.h"
+
+/**
+ * @brief Выводит справку по аргументам
+ */
+void printUsage() {
+    std::cout << "Использование:" << std::endl;
+    std::cout << "  shard_tool gen <total> <shard> <shards> <seed> <prefix> [r h cx cy cz nx ny nz]" << std::endl;
+    std::cout << "  shard_tool verify <manifest>..." << std::endl;
+    std::cout << "  shard_tool merge <prefix> <manifest>..." << std::endl;
+    std::cout << "  shard_tool index <index.manifest> <manifest>..." << std::endl;
+}
+
+/**
+ * @brief Загружает манифесты из списка аргументов
+ * @param argc Число аргументов
+ * @param argv Аргументы
+ * @param first Номер первого аргумента-манифеста
+ * @param manifests Загруженные манифесты
+ * @return true, если все манифесты прочитаны
+ */
+bool loadManifests(int argc, char** argv, int first, std::vector<ShardManifest>& manifests) {
+    for (int i = first; i < argc; ++i) {
+        ShardManifest m;
+        std::string error;
+        if (!m.load(argv[i], error)) {
+            std::cout << "Ошибка: " << error << std::endl;
+            return false;
+        }
+        manifests.push_back(m);
+    }
+    if (manifests.empty()) {
+        std::cout << "Ошибка: не указаны манифесты" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Основная функция утилиты
+ * @param argc Число аргументов
+ * @param argv Аргументы
+ * @return Код завершения (0 - успех)
+ */
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    std::string command = argv[1];
+
+    if (command == "gen") {
+        if (argc != 7 && argc != 15) {
+            printUsage();
+            return 1;
+        }
+        uint64_t total, shard, shards, seed;
+        std::string prefix = argv[6];
+
+        // Параметры по умолчанию - как в main.cpp
+        ConeGen generator(1.0, 2.0);
+        try {
+            total = std::stoull(argv[2]);
+            shard = std::stoull(argv[3]);
+            shards = std::stoull(argv[4]);
+            seed = std::stoull(argv[5]);
+            if (argc == 15) {
+                double v[8];
+                for (int i = 0; i < 8; ++i) v[i] = std::stod(argv[7 + i]);
+                generator.setParams(v[0], v[1], point3d(v[2], v[3], v[4]), point3d(v[5], v[6], v[7]));
+            }
+        } catch (const std::exception&) {
+            // std::invalid_argument или std::out_of_range - не число
+            printUsage();
+            return 1;
+        }
+        generator.setSeed(seed);
+
+        if (shards == 0 || shard >= shards) {
+            std::cout << "Ошибка: номер шарда должен быть меньше числа шардов" << std::endl;
+            return 1;
+        }
+        ConeShard part(generator, total, shard, shards);
+        if (!part.write(prefix)) {
+            std::cout << "Ошибка записи " << prefix << ".bin / " << prefix << ".manifest" << std::endl;
+            return 1;
+        }
+        std::cout << "Шард " << shard << "/" << shards << ": точки [" << part.begin() << ", "
+                  << part.end() << ") записаны в " << prefix << ".bin" << std::endl;
+        return 0;
+    }
+
+    std::vector<ShardManifest> manifests;
+    std::string error;
+
+    if (command == "verify") {
+        uint64_t checksum = 0;
+        if (!loadManifests(argc, argv, 2, manifests)) return 1;
+        if (!ConeShard::verify(manifests, error, &checksum)) {
+            std::cout << "Ошибка: " << error << std::endl;
+            return 1;
+        }
+        std::cout << "OK: " << manifests.size() << " манифест(ов), " << manifests.front().total
+                  << " точек, checksum=" << std::hex << checksum << std::dec << std::endl;
+        return 0;
+    }
+
+    if (command == "merge" || command == "index") {
+        if (argc < 4) {
+            printUsage();
+            return 1;
+        }
+        if (!loadManifests(argc, argv, 3, manifests)) return 1;
+        bool ok = command == "merge" ? ConeShard::merge(manifests, argv[2], error)
+                                     : ConeShard::index(manifests, argv[2], error);
+        if (!ok) {
+            std::cout << "Ошибка: " << error << std::endl;
+            return 1;
+        }
+        std::cout << (command == "merge" ? "Шарды склеены в " : "Индекс записан в ") << argv[2]
+                  << std::endl;
+        return 0;
+    }
+
+    printUsage();
+    return 1;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file splitmix.h
+ * @brief Генератор splitmix64 для детерминированных потоков случайных чисел
+ * @author Perevozchikov M
+ * @date 2025
+ */
+
+#ifndef SPLITMIX_H
+#define SPLITMIX_H
+
+#include <cstdint>
+
+/**
+ * @brief Шаг генератора splitmix64
+ * @param state Состояние генератора (счетчик с шагом 0x9E3779B97F4A7C15)
+ * @return Очередное 64-битное случайное число
+ */
+inline uint64_t splitmix64(uint64_t& state) {
+    state += 0x9E3779B97F4A7C15ULL;
+    uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Переводит 64-битное число в double из [0, 1)
+ * @param x Случайное число
+ * @return Равномерное число из [0, 1)
+ */
+inline double toUnit(uint64_t x) {
+    return (x >> 11) * 0x1.0p-53;
+}
+
+#endif
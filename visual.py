@@ -1,63 +1,201 @@
 """
 @file visual.py
-@brief Скрипт для 3D визуализации точек из файла points.txt
+@brief Скрипт для 3D визуализации точек из файла points.txt или из libcone.so
 @author Perevozchikov M
 @date 2025-09-28
+
+Режимы:
+    python visual.py                 - точки из points.txt (np.loadtxt)
+    python visual.py --lib N         - N точек из libcone.so прямо в массив NumPy
+    python visual.py --bench N       - сравнение времени загрузки: loadtxt и libcone.so
 """
 
-import matplotlib.pyplot as plt
+import argparse
+import ctypes
+import os
+import time
+
 import numpy as np
-from mpl_toolkits.mplot3d import Axes3D
+
+## Раскладки и типы буфера из cone_capi.h
+CONE_LAYOUT_AOS = 0
+CONE_LAYOUT_SOA = 1
+CONE_DTYPE_F64 = 0
+CONE_DTYPE_F32 = 1
+
+
+def load_library(path=None):
+    """
+    @brief Загружает libcone.so и описывает сигнатуры функций C ABI
+    @param path Путь к библиотеке (по умолчанию рядом со скриптом)
+    @return Объект ctypes.CDLL
+    """
+    if path is None:
+        path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'libcone.so')
+    lib = ctypes.CDLL(path)
+
+    lib.cone_abi_version.restype = ctypes.c_int
+    lib.cone_gen_create.argtypes = [ctypes.c_double, ctypes.c_double]
+    lib.cone_gen_create.restype = ctypes.c_void_p
+    lib.cone_gen_destroy.argtypes = [ctypes.c_void_p]
+    lib.cone_gen_destroy.restype = None
+    lib.cone_gen_set_params.argtypes = [ctypes.c_void_p] + [ctypes.c_double] * 8
+    lib.cone_gen_set_seed.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+    lib.cone_gen_rotate.argtypes = [ctypes.c_void_p] + [ctypes.c_double] * 4
+    lib.cone_gen_get_params.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_double)]
+    lib.cone_gen_generate.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_uint64,
+                                      ctypes.c_void_p, ctypes.c_int, ctypes.c_int]
+    for name in ('cone_gen_set_params', 'cone_gen_get_params', 'cone_gen_set_seed',
+                 'cone_gen_rotate', 'cone_gen_generate'):
+        getattr(lib, name).restype = ctypes.c_int
+
+    if lib.cone_abi_version() != 1:
+        raise RuntimeError('несовместимая версия ABI libcone.so')
+    return lib
+
+
+def generate_points(lib, count, seed=0, radius=1.0, height=2.0, dtype=np.float64):
+    """
+    @brief Генерирует точки через libcone.so прямо в массив NumPy (без копий)
+    @param lib Библиотека из load_library()
+    @param count Число точек
+    @param seed Зерно генератора
+    @param radius Радиус конуса
+    @param height Высота конуса
+    @param dtype np.float64 или np.float32
+    @return Массив формы (3, count): строки x, y, z (раскладка SoA)
+    """
+    code = CONE_DTYPE_F32 if dtype == np.float32 else CONE_DTYPE_F64
+    data = np.empty((3, count), dtype=dtype)
+    gen = lib.cone_gen_create(radius, height)
+    if not gen:
+        raise MemoryError('cone_gen_create')
+    try:
+        lib.cone_gen_set_seed(gen, seed)
+        status = lib.cone_gen_generate(gen, 0, count, data.ctypes.data,
+                                       CONE_LAYOUT_SOA, code)
+        if status != 0:
+            raise RuntimeError(f'cone_gen_generate вернула {status}')
+    finally:
+        lib.cone_gen_destroy(gen)
+    return data
+
+
+def load_points_txt(filename='points.txt'):
+    """
+    @brief Читает точки из текстового файла
+    @param filename Имя файла
+    @return Массив формы (3, N) или None, если файл пуст
+    """
+    data = np.loadtxt(filename, ndmin=2)
+    if data.size == 0:
+        return None
+    return data.T
+
+
+def plot_points(x, y, z):
+    """
+    @brief Строит 3D диаграмму рассеяния точек
+    @param x Координаты X
+    @param y Координаты Y
+    @param z Координаты Z
+    """
+    import matplotlib.pyplot as plt
+
+    print("Создание 3D визуализации...")
+
+    # Создание фигуры и 3D оси
+    fig = plt.figure(figsize=(10, 8))
+    ax = fig.add_subplot(111, projection='3d')
+
+    # Правильные подписи осей (соответствуют системе координат C++)
+    ax.scatter(x, y, z, c=z, cmap='viridis', alpha=0.7, s=20)
+
+    ax.set_xlabel('Y (→)')
+    ax.set_ylabel('X (↑)')
+    ax.set_zlabel('Z (⬆)')
+
+    ax.set_title('Точки в конусе')
+
+    # Сетка
+    ax.grid(True, linestyle='--', alpha=0.3)
+
+    # Начальный угол обзора
+    ax.view_init(elev=25, azim=45)
+
+    # Сохраняем пропорции
+    ax.set_box_aspect([1, 1, 1])
+
+    print("Загрузка графика...")
+
+    # Показать график
+    plt.show()
+
+    print("Визуализация завершена!")
+
+
+def benchmark(count, filename='bench_points.txt'):
+    """
+    @brief Сравнивает получение точек через loadtxt и через libcone.so
+    @param count Число точек
+    @param filename Временный файл для пути через loadtxt
+    """
+    lib = load_library()
+
+    start = time.perf_counter()
+    data = generate_points(lib, count)
+    lib_time = time.perf_counter() - start
+
+    start = time.perf_counter()
+    generate_points(lib, count, dtype=np.float32)
+    lib32_time = time.perf_counter() - start
+
+    # Тот же формат, что пишет main.cpp (пункт меню 2)
+    np.savetxt(filename, data.T, fmt='%.6g')
+    try:
+        start = time.perf_counter()
+        loaded = np.loadtxt(filename, ndmin=2)
+        txt_time = time.perf_counter() - start
+    finally:
+        os.remove(filename)
+
+    print(f"Точек: {count}")
+    print(f"np.loadtxt:         {txt_time:8.3f} с ({count / txt_time / 1e6:8.2f} млн точек/с)")
+    print(f"libcone.so float64: {lib_time:8.3f} с ({count / lib_time / 1e6:8.2f} млн точек/с)")
+    print(f"libcone.so float32: {lib32_time:8.3f} с ({count / lib32_time / 1e6:8.2f} млн точек/с)")
+    print(f"Ускорение: {txt_time / lib_time:.1f}x; "
+          f"max |разница| = {np.abs(loaded.T - data).max():.2e} (округление текста)")
+
 
 def main():
+    parser = argparse.ArgumentParser(description='Визуализация точек в конусе')
+    group = parser.add_mutually_exclusive_group()
+    group.add_argument('--lib', type=int, metavar='N',
+                       help='сгенерировать N точек через libcone.so вместо points.txt')
+    group.add_argument('--bench', type=int, metavar='N',
+                       help='сравнить время loadtxt и libcone.so на N точках')
+    parser.add_argument('--seed', type=int, default=0, help='зерно генератора (для --lib)')
+    args = parser.parse_args()
+
     try:
-        print("Чтение данных из points.txt...")
-        data = np.loadtxt('points.txt')
-        
-        if data.size == 0:
-            print("Файл points.txt пуст!")
+        if args.bench is not None:
+            benchmark(args.bench)
             return
-            
-        # Обработка случая с одной точкой
-        if data.ndim == 1:
-            x, y, z = data[0], data[1], data[2]
-            x, y, z = [x], [y], [z]
+
+        if args.lib is not None:
+            print("Генерация точек через libcone.so...")
+            data = generate_points(load_library(), args.lib, seed=args.seed)
         else:
-            x, y, z = data[:, 0], data[:, 1], data[:, 2]
-        
+            print("Чтение данных из points.txt...")
+            data = load_points_txt()
+            if data is None:
+                print("Файл points.txt пуст!")
+                return
+
+        x, y, z = data
         print(f"Загружено {len(x)} точек")
-        
-        print("Создание 3D визуализации...")
-        
-        # Создание фигуры и 3D оси
-        fig = plt.figure(figsize=(10, 8))
-        ax = fig.add_subplot(111, projection='3d')
-        
-        # Правильные подписи осей (соответствуют системе координат C++)
-        ax.scatter(x, y, z, c=z, cmap='viridis', alpha=0.7, s=20)
-        
-        ax.set_xlabel('Y (→)')
-        ax.set_ylabel('X (↑)')
-        ax.set_zlabel('Z (⬆)')
-        
-        ax.set_title('Точки в конусе')
-        
-        # Сетка
-        ax.grid(True, linestyle='--', alpha=0.3)
-        
-        # Начальный угол обзора
-        ax.view_init(elev=25, azim=45)
-        
-        # Сохраняем пропорции
-        ax.set_box_aspect([1, 1, 1])  
-        
-        print("Загрузка графика...")
-        
-        # Показать график
-        plt.show()
-        
-        print("Визуализация завершена!")
-        
+        plot_points(x, y, z)
+
     except FileNotFoundError:
         print("Ошибка: файл points.txt не найден!")
     except Exception as e: